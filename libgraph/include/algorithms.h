@@ -8,6 +8,9 @@
 
 #include "graph.h"
 #include "vlist.h"
+#include "csr.h"
+#include "workspace.h"
+
 
 /*
  * Does a breadth-first traversal of a graph,
@@ -54,6 +57,23 @@ int graph_dfs(graph_t *g, unsigned int start);
  */
 int graph_toposort(graph_t *g, unsigned int start, vlist_t **l);
 
+/*
+ * Does a topological sort of a graph, like graph_toposort,
+ * using a workspace instead of allocating one
+ *
+ * Parameters:
+ *  - g, start, l: As in graph_toposort
+ *  - ws: The workspace (see workspace.h). If NULL, the function
+ *        allocates its own.
+ *
+ * Returns:
+ *  - 0 on success. If so, this function allocates a list_t
+ *    in the heap, and stores the pointer to the list_t in *l.
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_toposort_ws(graph_t *g, unsigned int start, vlist_t **l, graph_workspace_t *ws);
+
 /*
  * Does a depth-first traversal of a graph,
  * printing each vertex it visits.
@@ -85,4 +105,897 @@ int graph_dfs_iter(graph_t *g, unsigned int start);
  */
 int graph_spanning_tree(graph_t *g, unsigned int start, graph_t **tree);
 
-#endif
\ No newline at end of file
+
+/* TRAVERSALS WITHOUT I/O
+ *
+ * The functions above print every vertex (or edge) they visit. The
+ * functions below perform the same traversals, but instead of printing,
+ * they call a visitor function and/or fill in arrays provided by the
+ * caller, as specified in a graph_traversal_t struct.
+ */
+
+/*
+ * Visitor function, called for each vertex visited by a traversal
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - i: The numerical index of the vertex being visited
+ *  - parent: The vertex from which i was reached (GRAPH_NO_VERTEX if
+ *            the traversal started at i)
+ *  - arg: The 'arg' field of the graph_traversal_t struct
+ *
+ * Returns:
+ *  - 0 to continue the traversal. Any other value stops the traversal,
+ *    and is returned by the traversal function.
+ */
+typedef int (*graph_visit_fn)(graph_t *g, unsigned int i, unsigned int parent, void *arg);
+
+/* Specifies what a traversal does with the vertices it visits.
+ * Any field can be NULL. */
+typedef struct graph_traversal {
+    /* Function to call for each visited vertex, and
+     * argument to pass to it */
+    graph_visit_fn visit;
+    void *arg;
+
+    /* If not NULL, an array of g->n_vertices entries where the
+     * visited vertices are stored, in the order they are visited */
+    unsigned int *order;
+
+    /* If not NULL, an array of g->n_vertices entries where the
+     * parent of each vertex in the traversal tree is stored
+     * (GRAPH_NO_VERTEX for roots and unvisited vertices) */
+    unsigned int *parent;
+
+    /* If not NULL, an array of g->n_vertices entries where the
+     * depth of each vertex in the traversal tree is stored
+     * (GRAPH_NO_VERTEX for unvisited vertices) */
+    unsigned int *depth;
+
+    /* Set by the traversal to the number of vertices visited */
+    unsigned int n_visited;
+
+    /* If not NULL, the workspace to use (see workspace.h). Otherwise,
+     * the traversal allocates its own. */
+    graph_workspace_t *ws;
+} graph_traversal_t;
+
+/*
+ * Does a breadth-first traversal of a graph
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - start: The numerical index of the start vertex
+ *  - t: What to do with the visited vertices (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ *  - Any other value returned by the visitor function
+ */
+int graph_bfs_traverse(graph_t *g, unsigned int start, graph_traversal_t *t);
+
+/*
+ * Does a depth-first traversal of a graph. Like graph_dfs, once the
+ * vertices reachable from the start vertex have been visited, the
+ * traversal continues from every vertex that has not been visited yet.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - start: The numerical index of the start vertex
+ *  - t: What to do with the visited vertices (can be NULL)
+ *  - n_components: Out parameter (can be NULL) for the number of
+ *                  traversals that were needed to visit every vertex
+ *                  (>= 1). Only set on success.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ *  - Any other value returned by the visitor function
+ */
+int graph_dfs_traverse(graph_t *g, unsigned int start, graph_traversal_t *t,
+                       unsigned int *n_components);
+
+/*
+ * Does an iterative depth-first traversal of a graph, in
+ * the same order as graph_dfs_iter
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - start: The numerical index of the start vertex
+ *  - t: What to do with the visited vertices (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ *  - Any other value returned by the visitor function
+ */
+int graph_dfs_iter_traverse(graph_t *g, unsigned int start, graph_traversal_t *t);
+
+/*
+ * Produces the DFS predecessor tree of a graph, like graph_spanning_tree.
+ * Every vertex added to the tree is visited, with its parent in the tree.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - start: The numerical index of the start vertex
+ *  - tree: Out parameter for the predecessor tree
+ *  - t: What to do with the visited vertices (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success. If so, this function allocates a graph_t
+ *    in the heap, and stores the pointer to the graph_t in *tree.
+ *    Otherwise, *tree is set to NULL.
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ *  - Any other value returned by the visitor function
+ */
+int graph_spanning_tree_traverse(graph_t *g, unsigned int start, graph_t **tree,
+                                 graph_traversal_t *t);
+
+
+/* DIRECTION-OPTIMIZING BFS */
+
+/* Default thresholds for graph_bfs_diropt and graph_csr_bfs_diropt */
+#define GRAPH_BFS_ALPHA (14)
+#define GRAPH_BFS_BETA (24)
+
+/*
+ * Does a direction-optimizing breadth-first traversal of a graph.
+ *
+ * While the frontier is small, the traversal goes top-down: it follows
+ * the out-edges of the vertices in the frontier. Once the out-edges of
+ * the frontier outnumber 1/alpha of the edges that have not been
+ * explored yet, it switches to bottom-up: every unvisited vertex looks
+ * for an in-edge coming from the frontier. It switches back to top-down
+ * once the frontier stops growing and has fewer than 1/beta of the
+ * vertices. On graphs with a small diameter (such as social networks),
+ * this checks far fewer edges than graph_bfs_traverse.
+ *
+ * This function builds a CSR snapshot of the graph and of its transpose
+ * for the traversal. When doing several traversals of the same graph,
+ * build them once and use graph_csr_bfs_diropt instead.
+ *
+ * As with graph_bfs_parallel, the depths are the same as those found
+ * by graph_bfs_traverse, but the parents may differ.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - start: The numerical index of the start vertex
+ *  - alpha: Threshold for switching to bottom-up (0 to use
+ *           GRAPH_BFS_ALPHA). Larger values switch sooner.
+ *  - beta: Threshold for switching back to top-down (0 to use
+ *          GRAPH_BFS_BETA). Larger values switch later.
+ *  - depth: Out parameter. Must point to an array of g->n_vertices
+ *           entries, where the depth of each vertex in the BFS tree
+ *           is stored (GRAPH_NO_VERTEX for unreachable vertices)
+ *  - parent: Out parameter. Must either be NULL, or point to an array
+ *            of g->n_vertices entries, where the parent of each vertex
+ *            in the BFS tree is stored (GRAPH_NO_VERTEX for the start
+ *            vertex and unreachable vertices)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_bfs_diropt(graph_t *g, unsigned int start, unsigned int alpha, unsigned int beta,
+                     unsigned int *depth, unsigned int *parent);
+
+/*
+ * Does a direction-optimizing breadth-first traversal of a graph,
+ * like graph_bfs_diropt, using snapshots built ahead of time.
+ *
+ * Parameters:
+ *  - out: A snapshot of the graph, built by graph_freeze
+ *  - in: A snapshot of the transpose of the same graph,
+ *        built by graph_freeze_transpose
+ *  - start, alpha, beta, depth, parent: As in graph_bfs_diropt
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_bfs_diropt(graph_csr_t *out, graph_csr_t *in, unsigned int start,
+                         unsigned int alpha, unsigned int beta,
+                         unsigned int *depth, unsigned int *parent);
+
+
+/* MULTI-SOURCE BFS */
+
+/* Largest number of sources for graph_msbfs and graph_csr_msbfs */
+#define GRAPH_MSBFS_MAX_SOURCES (256)
+
+/*
+ * Does breadth-first traversals from several sources at once, and
+ * finds the distance (number of edges) from each source to each vertex.
+ *
+ * Each vertex keeps one bit per source, so the traversals share their
+ * scans of the edges: the edges of a vertex are scanned once per level
+ * in which some traversals reach it, instead of once per traversal.
+ * On graphs with a small diameter (such as social networks), where the
+ * traversals soon overlap, this is much faster than running a separate
+ * BFS from each source. On graphs with a large diameter and sources far
+ * apart (such as road networks), the traversals rarely share a level,
+ * and separate BFSs can be faster.
+ *
+ * This function builds a CSR snapshot of the graph for the traversals.
+ * When answering several batches of queries on the same graph, build
+ * it once and use graph_csr_msbfs instead.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - sources: The numerical indices of the sources (which may repeat)
+ *  - n_sources: The number of sources (between 1 and
+ *               GRAPH_MSBFS_MAX_SOURCES)
+ *  - dist: Out parameter. Must point to an array of n_sources *
+ *          g->n_vertices entries. The distance from sources[s] to
+ *          vertex i is stored in dist[s * g->n_vertices + i]
+ *          (GRAPH_NO_VERTEX if i can't be reached from sources[s]).
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: If one of the sources is invalid
+ *  - EINVAL: If the number of sources is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_msbfs(graph_t *g, const unsigned int *sources, unsigned int n_sources,
+                unsigned int *dist);
+
+/*
+ * Does breadth-first traversals from several sources at once, like
+ * graph_msbfs, using a snapshot built ahead of time.
+ *
+ * Parameters:
+ *  - csr: A snapshot of the graph, built by graph_freeze
+ *  - sources, n_sources, dist: As in graph_msbfs (with csr->n_vertices
+ *                              entries per source in dist)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: If one of the sources is invalid
+ *  - EINVAL: If the number of sources is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_msbfs(graph_csr_t *csr, const unsigned int *sources, unsigned int n_sources,
+                    unsigned int *dist);
+
+
+/* PARALLEL TRAVERSALS */
+
+/*
+ * Does a breadth-first traversal of a graph using several threads.
+ * The traversal is level-synchronous: each level of the BFS tree is
+ * explored in parallel before moving on to the next one.
+ *
+ * Since vertices in the same level are explored concurrently, the
+ * parent of a vertex may be any of its neighbours in the previous level
+ * (i.e., it may differ from the parent found by graph_bfs_traverse),
+ * but the depths are always the same.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - start: The numerical index of the start vertex
+ *  - n_threads: Number of threads to use (0 to use one thread
+ *               per processor)
+ *  - depth: Out parameter. Must point to an array of g->n_vertices
+ *           entries, where the depth of each vertex in the BFS tree
+ *           is stored (GRAPH_NO_VERTEX for unreachable vertices)
+ *  - parent: Out parameter. Must either be NULL, or point to an array
+ *            of g->n_vertices entries, where the parent of each vertex
+ *            in the BFS tree is stored (GRAPH_NO_VERTEX for the start
+ *            vertex and unreachable vertices)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_bfs_parallel(graph_t *g, unsigned int start, unsigned int n_threads,
+                       unsigned int *depth, unsigned int *parent);
+
+
+/* CSR FUNCTIONS
+ *
+ * These functions behave like their counterparts above, except they
+ * run on a CSR snapshot of a graph (see csr.h) instead of on the
+ * graph itself.
+ *
+ * The *_traverse functions take a graph_traversal_t, whose arrays must
+ * have csr->n_vertices entries. Its visitor function is called with
+ * the graph the snapshot was built from (csr->source, which is NULL if
+ * the snapshot was loaded from a file), and its 'ws' field is ignored.
+ */
+
+/*
+ * Does a breadth-first traversal of a CSR snapshot,
+ * printing each vertex it visits.
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - start: The numerical index of the start vertex
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_bfs(graph_csr_t *csr, unsigned int start);
+
+/*
+ * Does a breadth-first traversal of a CSR snapshot, like graph_csr_bfs,
+ * but without printing anything
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - start: The numerical index of the start vertex
+ *  - t: What to do with the visited vertices (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ *  - Any other value returned by the visitor function
+ */
+int graph_csr_bfs_traverse(graph_csr_t *csr, unsigned int start, graph_traversal_t *t);
+
+/*
+ * Does a depth-first traversal of a CSR snapshot, printing
+ * each vertex it visits. Like graph_dfs, once the vertices reachable
+ * from the start vertex have been visited, the traversal continues
+ * from every vertex that has not been visited yet.
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - start: The numerical index of the start vertex
+ *
+ * Returns:
+ *  - The number of traversals that were needed to visit
+ *    every vertex (>= 1)
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_dfs(graph_csr_t *csr, unsigned int start);
+
+/*
+ * Does a depth-first traversal of a CSR snapshot, like graph_csr_dfs,
+ * but without printing anything
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - start: The numerical index of the start vertex
+ *  - t: What to do with the visited vertices (can be NULL)
+ *  - n_components: Out parameter (can be NULL) for the number of
+ *                  traversals that were needed to visit every vertex
+ *                  (>= 1). Only set on success.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ *  - Any other value returned by the visitor function
+ */
+int graph_csr_dfs_traverse(graph_csr_t *csr, unsigned int start, graph_traversal_t *t,
+                           unsigned int *n_components);
+
+/*
+ * Does a topological sort of a CSR snapshot
+ *
+ * Parameters:
+ *  - csr: The snapshot. Must be a DAG (directed acyclic graph)
+ *  - start: The numerical index of the start vertex
+ *  - order: Out parameter to return the indices of the vertices,
+ *           topologically ordered. Must point to an array with room
+ *           for at least csr->n_vertices indices.
+ *  - n_order: Out parameter to return the number of vertices
+ *             stored in 'order'
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_toposort(graph_csr_t *csr, unsigned int start,
+                       unsigned int *order, unsigned int *n_order);
+
+/*
+ * Produces a spanning tree from a CSR snapshot (and, specifically
+ * the DFS predecessor tree), printing each edge of the tree.
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - start: The numerical index of the start vertex
+ *  - tree: Out parameter for the predecessor tree
+ *
+ * Returns:
+ *  - 0 on success. If so, this function allocates a graph_t
+ *    in the heap, and stores the pointer to the graph_t in *tree.
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_spanning_tree(graph_csr_t *csr, unsigned int start, graph_t **tree);
+
+/*
+ * Produces the DFS predecessor tree of a CSR snapshot, like
+ * graph_csr_spanning_tree, but without printing anything. The visitor
+ * is called for every vertex added to the tree (its parent is the
+ * other end of the tree edge).
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - start: The numerical index of the start vertex
+ *  - tree: Out parameter for the predecessor tree
+ *  - t: What to do with the visited vertices (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success. If so, this function allocates a graph_t
+ *    in the heap, and stores the pointer to the graph_t in *tree.
+ *    Otherwise, *tree is set to NULL.
+ *  - EINDEX: if the start index is invalid
+ *  - ENOMEM: If there was insufficient memory
+ *  - Any other value returned by the visitor function
+ */
+int graph_csr_spanning_tree_traverse(graph_csr_t *csr, unsigned int start, graph_t **tree,
+                                     graph_traversal_t *t);
+
+
+/* TOPOLOGICAL SORTING */
+
+/*
+ * Does a topological sort of a whole graph, using Kahn's algorithm:
+ * vertices with no incoming edges are output first, and removing them
+ * from the graph makes more vertices available. Unlike graph_toposort,
+ * this sorts every vertex (not just the ones reachable from a start
+ * vertex) and detects cycles. Runs in O(V+E) time.
+ *
+ * Available vertices are output in FIFO order: the ones with no incoming
+ * edges first, by increasing index, and then the others in the order in
+ * which they become available, following the edge lists. The order is
+ * deterministic, but lower indices do not necessarily go first (with the
+ * edges 0->1 and 0->2, vertex 2 may come before vertex 1).
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - order: Out parameter. Must point to an array of g->n_vertices
+ *           entries, where the indices of the vertices are stored in
+ *           topological order. If the graph has a cycle, the vertices
+ *           that could be sorted are stored here, and the rest of the
+ *           array is left undefined.
+ *  - cycle: Out parameter. Must either be NULL, or point to an array of
+ *           g->n_vertices entries. If the graph has a cycle, the indices
+ *           of the vertices in one of its cycles are stored here, in
+ *           the order of the edges (the last vertex has an edge to the
+ *           first one).
+ *  - n_cycle: Out parameter. Must be NULL if cycle is NULL. Set to the
+ *             length of the cycle stored in 'cycle' (0 if there is none).
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ECYCLE: If the graph has a cycle
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_toposort_kahn(graph_t *g, unsigned int *order,
+                        unsigned int *cycle, unsigned int *n_cycle);
+
+
+/*
+ * Splits a DAG into levels: vertices in the same level have no paths
+ * between them, so they can be processed concurrently once the previous
+ * levels are done. Level 0 has the vertices without incoming edges, and
+ * every other vertex is in the level after that of its last predecessor,
+ * so the number of levels is the number of vertices in the longest path.
+ *
+ * The levels are computed with Kahn's algorithm, processing each level
+ * with several threads. The order of the vertices within a level is
+ * unspecified.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - n_threads: Number of threads to use (0 to use one thread
+ *               per processor)
+ *  - order: Out parameter. Must point to an array of g->n_vertices
+ *           entries, where the indices of the vertices are stored,
+ *           level by level. If the graph has a cycle, only the levels
+ *           that could be computed are stored.
+ *  - level_start: Out parameter. Must point to an array of
+ *                 g->n_vertices + 1 entries. Level l is stored in
+ *                 order[level_start[l]] through
+ *                 order[level_start[l+1] - 1].
+ *  - n_levels: Out parameter for the number of levels
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ECYCLE: If the graph has a cycle
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_toposort_levels(graph_t *g, unsigned int n_threads, unsigned int *order,
+                          unsigned int *level_start, unsigned int *n_levels);
+
+/*
+ * Finds the critical path of a DAG: the path with the largest total
+ * weight, where edge weights are the durations of tasks that must be
+ * done in sequence. This is the shortest time in which every task can
+ * be completed, however many run concurrently. Runs in O(V+E) time.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - order: Every vertex of g, in topological order (as produced by
+ *           graph_toposort_kahn or graph_toposort_levels)
+ *  - length: Out parameter for the total weight of the path
+ *  - path: Out parameter. Must point to an array of g->n_vertices
+ *          entries, where the indices of the vertices on the path
+ *          are stored, in order.
+ *  - n_path: Out parameter for the number of vertices on the path
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_critical_path(graph_t *g, unsigned int *order, double *length,
+                        unsigned int *path, unsigned int *n_path);
+
+
+/* CONNECTED COMPONENTS */
+
+/*
+ * Finds the connected components of a graph, ignoring the direction of
+ * the edges (i.e., its weakly connected components). Uses a disjoint-set
+ * forest, so it runs in nearly O(V+E) time and does not recurse.
+ *
+ * Components are numbered from 0, in order of their lowest vertex index,
+ * so the vertices in the same component as vertex 0 are in component 0.
+ * Removed vertices are not in any component.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - comp: Out parameter. Must point to an array of g->n_vertices
+ *          entries, where the component of each vertex is stored
+ *          (GRAPH_NO_VERTEX for removed vertices)
+ *  - n_comp: Out parameter for the number of components
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_connected_components(graph_t *g, unsigned int *comp, unsigned int *n_comp);
+
+/*
+ * Finds the connected components of a graph using several threads, with
+ * a lock-free union-find. The components and their numbering are the
+ * same as those computed by graph_connected_components.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - n_threads: Number of threads to use (0 to use one thread
+ *               per processor)
+ *  - comp: Out parameter. Must point to an array of g->n_vertices
+ *          entries, where the component of each vertex is stored
+ *          (GRAPH_NO_VERTEX for removed vertices)
+ *  - n_comp: Out parameter for the number of components
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_connected_components_parallel(graph_t *g, unsigned int n_threads,
+                                        unsigned int *comp, unsigned int *n_comp);
+
+
+/*
+ * Finds the strongly connected components of a graph (i.e., the largest
+ * sets of vertices where there is a path from every vertex to every
+ * other one), using Tarjan's algorithm. It uses explicit stacks instead
+ * of recursion, so it works on graphs of any size. Runs in O(V+E) time.
+ *
+ * Components are numbered in topological order: if there is an edge
+ * from component a to component b, then a < b. Removed vertices are not
+ * in any component.
+ *
+ * Optionally, builds the condensation of the graph: a DAG with one vertex
+ * per component, and an edge from a to b if there is any edge from a
+ * vertex of a to a vertex of b. The weight of the edge is the smallest
+ * weight of those edges, and each vertex is labelled after the lowest
+ * vertex of its component.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - comp: Out parameter. Must point to an array of g->n_vertices
+ *          entries, where the component of each vertex is stored
+ *          (GRAPH_NO_VERTEX for removed vertices)
+ *  - n_comp: Out parameter for the number of components
+ *  - cond: Out parameter for the condensation. If it is NULL, the
+ *          condensation is not built. Otherwise, a new graph is
+ *          allocated, and the caller must free it with graph_free
+ *          and free.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_scc(graph_t *g, unsigned int *comp, unsigned int *n_comp, graph_t **cond);
+
+
+/* MINIMUM SPANNING TREES */
+
+/*
+ * Finds a minimum spanning forest of a graph (a minimum spanning tree of
+ * each of its connected components) using Kruskal's algorithm: the edges
+ * are sorted by weight, using several threads, and each one is added to
+ * the forest unless it would close a cycle (which is checked with a
+ * disjoint-set forest). Runs in O(E log E) time, which makes it a good
+ * choice for sparse graphs.
+ *
+ * The direction of the edges is ignored. If there are several minimum
+ * spanning forests, ties between edges with the same weight are broken
+ * by their endpoints, so the result does not depend on n_threads.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - n_threads: Number of threads to sort the edges with (0 to use
+ *               one thread per processor)
+ *  - tree: Out parameter. A new graph is allocated, with the same
+ *          vertices as g (including removed ones, which are also
+ *          removed in the new graph) and the edges of the forest, each
+ *          of them in both directions. The caller must free it with
+ *          graph_free and free.
+ *  - weight: Out parameter for the total weight of the forest
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_mst_kruskal(graph_t *g, unsigned int n_threads, graph_t **tree, double *weight);
+
+/*
+ * Finds a minimum spanning forest of a graph using Prim's algorithm: a
+ * tree is grown from a vertex by repeatedly adding the lightest edge
+ * between the tree and a vertex outside it, which is found with an
+ * indexed heap. Runs in O(E log V) time, which makes it a good choice
+ * for dense graphs.
+ *
+ * The direction of the edges is ignored. The forest has the same total
+ * weight as the one found by graph_mst_kruskal, but if there are several
+ * minimum spanning forests, it may be a different one.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - tree: Out parameter (see graph_mst_kruskal)
+ *  - weight: Out parameter for the total weight of the forest
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_mst_prim(graph_t *g, graph_t **tree, double *weight);
+
+
+/* SHORTEST PATHS */
+
+/*
+ * Computes the shortest paths from a vertex to every other vertex,
+ * using Dijkstra's algorithm with an indexed d-ary heap.
+ * Runs in O((V+E) log V) time.
+ *
+ * Parameters:
+ *  - g: The graph. All edge weights must be non-negative.
+ *  - source: The numerical index of the source vertex
+ *  - dist: Out parameter. Must point to an array of g->n_vertices
+ *          doubles. dist[i] is set to the length of the shortest path
+ *          from the source to vertex i (INFINITY if i is unreachable).
+ *  - pred: Out parameter. Must be NULL, or point to an array of
+ *          g->n_vertices unsigned ints. pred[i] is set to the vertex
+ *          before i in the shortest path from the source to i
+ *          (GRAPH_NO_VERTEX for the source and unreachable vertices)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: if the source index is invalid
+ *  - EINVAL: if a reachable edge has a negative weight
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_shortest_paths(graph_t *g, unsigned int source, double *dist, unsigned int *pred);
+
+/*
+ * Computes the shortest path between two vertices. This behaves like
+ * graph_shortest_paths, but stops as soon as the shortest path to the
+ * target is known.
+ *
+ * Parameters:
+ *  - g: The graph. All edge weights must be non-negative.
+ *  - source: The numerical index of the source vertex
+ *  - target: The numerical index of the target vertex
+ *  - dist: Same as in graph_shortest_paths. dist[target] and the
+ *          pred entries along the path to the target are final;
+ *          other entries may not be.
+ *  - pred: Same as in graph_shortest_paths.
+ *
+ * Returns:
+ *  - 0 on success (dist[target] is INFINITY if there is no path)
+ *  - EINDEX: if the source or target index is invalid
+ *  - EINVAL: if a reachable edge has a negative weight
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_shortest_path(graph_t *g, unsigned int source, unsigned int target,
+                        double *dist, unsigned int *pred);
+
+/* Algorithms for graph_all_shortest_paths */
+#define GRAPH_APSP_AUTO            (0)
+#define GRAPH_APSP_FLOYD_WARSHALL  (1)
+#define GRAPH_APSP_JOHNSON         (2)
+
+/* GRAPH_APSP_AUTO uses Johnson's algorithm for graphs with fewer
+ * than n^2 / GRAPH_APSP_DENSITY edges, and Floyd-Warshall otherwise */
+#define GRAPH_APSP_DENSITY (8)
+
+/*
+ * Computes the shortest paths between every pair of vertices of a
+ * graph. Edge weights may be negative, as long as there are no
+ * negative cycles. Two algorithms are available:
+ *  - GRAPH_APSP_FLOYD_WARSHALL: Floyd-Warshall on the distance matrix,
+ *    split into cache-sized tiles that are updated in parallel. Runs in
+ *    O(V^3) time, but its inner loop is vectorized, which makes it the
+ *    fastest choice for dense graphs.
+ *  - GRAPH_APSP_JOHNSON: Johnson's algorithm, which changes the weights
+ *    so none of them is negative (with Bellman-Ford) and then runs
+ *    Dijkstra's algorithm from every vertex in parallel. Runs in
+ *    O(V E log V) time, which is faster for sparse graphs.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - algorithm: One of the algorithms above, or GRAPH_APSP_AUTO to
+ *               choose one based on the density of the graph
+ *  - n_threads: Number of threads to use (0 to use one thread
+ *               per processor)
+ *  - dist: Out parameter. Must point to an array of n * n doubles,
+ *          where n = g->n_vertices. dist[i * n + j] is set to the
+ *          length of the shortest path from vertex i to vertex j
+ *          (INFINITY if there is none).
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ECYCLE: If the graph has a negative cycle (the contents of
+ *            dist are undefined)
+ *  - EINVAL: If the algorithm is unknown
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_all_shortest_paths(graph_t *g, int algorithm, unsigned int n_threads, double *dist);
+
+
+/* PAGERANK AND SPARSE MATRIX-VECTOR PRODUCTS */
+
+/* Usual damping factor for graph_pagerank */
+#define GRAPH_PAGERANK_DAMPING (0.85)
+
+/*
+ * Multiplies the adjacency matrix of a CSR snapshot by a vector: for
+ * every vertex i, y[i] is set to the sum of weight * x[j] over the
+ * edges i -> j in the snapshot. (For a transposed snapshot, this is the
+ * product of the transpose of the graph's adjacency matrix.) The rows
+ * are split between the threads, so that each of them gets about the
+ * same number of edges.
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - x: Array of csr->n_vertices entries
+ *  - y: Out parameter. Must point to an array of csr->n_vertices
+ *       entries (which must not overlap x).
+ *  - n_threads: Number of threads to use (0 to use one thread
+ *               per processor)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_spmv(graph_csr_t *csr, const double *x, double *y, unsigned int n_threads);
+
+/*
+ * Computes the PageRank of every vertex of a graph: the probability of
+ * being at that vertex after a long random walk, where each step follows
+ * a random edge of the current vertex with probability 'damping', and
+ * jumps to a random vertex otherwise (or if there are no edges to
+ * follow). Edge weights are ignored. Removed vertices are left out: the
+ * random walk never jumps to them, and their rank is 0.
+ *
+ * Starting from equal ranks, the ranks are updated by iterating until
+ * the total change in an iteration (the sum of the absolute changes of
+ * all the ranks) is less than 'tolerance'. Each iteration computes the
+ * new rank of every vertex from the vertices with edges to it, in
+ * parallel.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - damping: The damping factor, between 0 and 1 (usually
+ *             GRAPH_PAGERANK_DAMPING)
+ *  - tolerance: The total change at which to stop
+ *  - max_iter: The maximum number of iterations
+ *  - n_threads: Number of threads to use (0 to use one thread
+ *               per processor)
+ *  - rank: Out parameter. Must point to an array of g->n_vertices
+ *          entries, where the rank of each vertex is stored. The
+ *          ranks add up to 1.
+ *  - n_iter: Out parameter (can be NULL) for the number of iterations
+ *            done. If it is max_iter, the ranks may not have converged.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If the damping factor is not between 0 and 1
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_pagerank(graph_t *g, double damping, double tolerance,
+                   unsigned int max_iter, unsigned int n_threads,
+                   double *rank, unsigned int *n_iter);
+
+/*
+ * Computes the PageRank of every vertex, like graph_pagerank, from a
+ * transposed CSR snapshot of the graph (see graph_freeze_transpose),
+ * which can be reused between calls. A snapshot doesn't record which
+ * vertices were removed from the graph, so here they are ranked like
+ * any other vertex without edges (call graph_compact before taking the
+ * snapshot, or use graph_pagerank, to leave them out).
+ *
+ * Parameters:
+ *  - in: The transposed snapshot
+ *  - damping, tolerance, max_iter, n_threads: See graph_pagerank
+ *  - rank: Out parameter. Must point to an array of in->n_vertices
+ *          entries (see graph_pagerank).
+ *  - n_iter: See graph_pagerank
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If the snapshot is not transposed, or the damping factor
+ *            is not between 0 and 1
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_pagerank(graph_csr_t *in, double damping, double tolerance,
+                       unsigned int max_iter, unsigned int n_threads,
+                       double *rank, unsigned int *n_iter);
+
+
+/* VERTEX ORDERING */
+
+/* Orders for graph_reorder */
+#define GRAPH_ORDER_RCM     (0)
+#define GRAPH_ORDER_DEGREE  (1)
+#define GRAPH_ORDER_BFS     (2)
+
+/*
+ * Renumbers the vertices of a graph so that vertices that are used
+ * together are stored together, which makes traversals more
+ * cache-friendly. The graph is rebuilt with graph_permute, so the edges
+ * also end up stored contiguously, in the new order. Labels stay with
+ * their vertices, and removed vertices are moved to the end.
+ *
+ * The available orders are:
+ *  - GRAPH_ORDER_RCM: Reverse Cuthill-McKee, which numbers the vertices
+ *    in BFS order (ignoring the direction of the edges, starting each
+ *    component from a vertex with the fewest neighbours, and visiting
+ *    lower-degree neighbours first) and then reverses the numbering.
+ *    This keeps the neighbours of each vertex close to it.
+ *  - GRAPH_ORDER_DEGREE: Decreasing degree (incoming plus outgoing
+ *    edges), which keeps the busiest vertices together.
+ *  - GRAPH_ORDER_BFS: The order in which a BFS from vertex 0 (and then
+ *    from the lowest unvisited vertex, until there are none) visits
+ *    the vertices.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - method: One of the orders above
+ *  - old_to_new: Out parameter. Must either be NULL, or point to an
+ *                array of g->n_vertices entries, where the new index
+ *                of each vertex is stored.
+ *  - new_to_old: Out parameter. Must either be NULL, or point to an
+ *                array of g->n_vertices entries, where the old index
+ *                of each vertex is stored.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If the method is unknown
+ *  - ENOMEM: If there was insufficient memory (see graph_permute)
+ */
+int graph_reorder(graph_t *g, int method, unsigned int *old_to_new, unsigned int *new_to_old);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * Compressed sparse row (CSR) snapshots of a graph
+ *
+ * A CSR snapshot is a read-only copy of a graph's edges, stored in
+ * contiguous arrays instead of linked lists. Algorithms that only read
+ * the graph can run on a snapshot, which is much more cache-friendly
+ * than chasing edge_t pointers.
+ *
+ * The edges of vertex i are stored in positions offsets[i] through
+ * offsets[i+1]-1 of the targets and weights arrays, in the same order
+ * as they appear in the vertex's list of edges.
+ *
+ * Snapshots are not updated when the graph changes. Mutations still go
+ * through graph_t, and a snapshot can be rebuilt on demand with
+ * graph_csr_refresh.
+ *
+ */
+
+#ifndef INCLUDE_CSR_H_
+#define INCLUDE_CSR_H_
+
+#include "graph.h"
+
+
+/* DATA STRUCTURES */
+
+/* A CSR snapshot */
+typedef struct graph_csr {
+    /* The number of vertices and edges in the snapshot */
+    unsigned int n_vertices;
+    unsigned long n_edges;
+
+    /* Array of n_vertices + 1 offsets into targets and weights */
+    unsigned long *offsets;
+
+    /* Index of the vertex each edge leads to */
+    unsigned int *targets;
+
+    /* Weight of each edge */
+    double *weights;
+
+    /* Vertex labels. These point to the labels in the source graph
+     * or in the binary file (they are not copied), and can be NULL. */
+    char **labels;
+
+    /* The graph this snapshot was built from, and its version
+     * at the time the snapshot was built. The source is NULL if the
+     * snapshot was loaded from a file. */
+    graph_t *source;
+    unsigned long version;
+
+    /* Whether this is a snapshot of the transpose of the source graph */
+    bool transposed;
+
+    /* If the snapshot was loaded from a binary file, the arrays point
+     * into this memory mapping of the file (otherwise, it is NULL) */
+    void *map;
+    size_t map_len;
+} graph_csr_t;
+
+
+/* FUNCTIONS */
+
+/*
+ * Builds a CSR snapshot of a graph
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - csr: The snapshot to build. Must point to allocated memory.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_freeze(graph_t *g, graph_csr_t *csr);
+
+/*
+ * Builds a CSR snapshot of the transpose of a graph (i.e., of the
+ * graph with every edge reversed). In the snapshot, the edges of
+ * vertex i are the edges that lead *to* i in the graph, and their
+ * targets are the vertices they come from, in increasing order.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - csr: The snapshot to build. Must point to allocated memory.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_freeze_transpose(graph_t *g, graph_csr_t *csr);
+
+/*
+ * Checks whether a snapshot is out of date (i.e., whether its source
+ * graph has been modified since the snapshot was built)
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - csr: A snapshot built by graph_freeze
+ *
+ * Returns:
+ *  - true if the snapshot was not built from g, or if g has been
+ *    modified since the snapshot was built. false otherwise.
+ */
+bool graph_csr_is_stale(graph_t *g, graph_csr_t *csr);
+
+/*
+ * Rebuilds a snapshot, but only if it is out of date. Snapshots built
+ * by graph_freeze_transpose are rebuilt as transposes.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - csr: A snapshot built by graph_freeze or graph_freeze_transpose
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_csr_refresh(graph_t *g, graph_csr_t *csr);
+
+/*
+ * Loads a snapshot from a binary file created by graph_to_bin
+ *
+ * The file is memory-mapped, and the offsets, targets and weights arrays
+ * point directly into the mapping, so loading takes time proportional
+ * to the number of vertices but not to the number of edges. Edge targets
+ * are not validated, so the file must come from a trusted source.
+ *
+ * Parameters:
+ *  - csr: The snapshot to load. Must point to allocated memory.
+ *  - filename: The binary file
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ *  - EFILE: Error when opening/reading the file
+ *  - EPARSE: If the file is not a valid binary graph file
+ */
+int graph_csr_from_bin(graph_csr_t *csr, const char *filename);
+
+/*
+ * Frees resources associated with a snapshot
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int graph_csr_free(graph_csr_t *csr);
+
+#endif
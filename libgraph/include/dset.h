@@ -0,0 +1,100 @@
+/*
+ * Disjoint sets (union-find)
+ *
+ * This module keeps track of a partition of the integers between 0 and
+ * n-1 (typically, vertex indices) into disjoint sets, which can be merged.
+ * Each set is represented by one of its elements (its root). Sets are
+ * merged by size, and finding the root of an element halves the path to
+ * it, so any sequence of operations takes nearly linear time.
+ *
+ */
+
+#ifndef INCLUDE_DSET_H_
+#define INCLUDE_DSET_H_
+
+#include "graph.h"
+
+
+/* DATA STRUCTURES */
+
+/* A collection of disjoint sets */
+typedef struct dset {
+    /* Number of elements */
+    unsigned int n;
+
+    /* Number of sets */
+    unsigned int n_sets;
+
+    /* Parent of each element (roots are their own parent) */
+    unsigned int *parent;
+
+    /* Number of elements in each set (only meaningful for roots) */
+    unsigned int *size;
+} dset_t;
+
+
+/* FUNCTIONS */
+
+/*
+ * Initializes a collection of disjoint sets, where each element
+ * is in a set of its own
+ *
+ * Parameters:
+ *  - d: The collection to initialize. Must point to allocated memory.
+ *  - n: Number of elements
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int dset_init(dset_t *d, unsigned int n);
+
+/*
+ * Frees resources associated with a collection of disjoint sets
+ *
+ * Parameters:
+ *  - d: The collection
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int dset_free(dset_t *d);
+
+/*
+ * Finds the root of the set containing an element
+ *
+ * Parameters:
+ *  - d: The collection
+ *  - x: The element (must be less than d->n)
+ *
+ * Returns:
+ *  - The root of the set
+ */
+unsigned int dset_find(dset_t *d, unsigned int x);
+
+/*
+ * Merges the sets containing two elements
+ *
+ * Parameters:
+ *  - d: The collection
+ *  - x, y: The elements (must be less than d->n)
+ *
+ * Returns:
+ *  - true if the sets were merged, false if the elements
+ *    were already in the same set
+ */
+bool dset_union(dset_t *d, unsigned int x, unsigned int y);
+
+/*
+ * Checks whether two elements are in the same set
+ *
+ * Parameters:
+ *  - d: The collection
+ *  - x, y: The elements (must be less than d->n)
+ *
+ * Returns:
+ *  - true if they are in the same set, false otherwise
+ */
+bool dset_same(dset_t *d, unsigned int x, unsigned int y);
+
+#endif
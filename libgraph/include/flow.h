@@ -0,0 +1,103 @@
+/*
+ * Maximum flows and minimum cuts
+ *
+ * The edges of a graph are taken to be pipes, whose capacities are the
+ * edge weights. A flow sends some amount through each edge (no more than
+ * its capacity) so that, at every vertex other than the source and the
+ * sink, the amount that comes in is the amount that goes out. A maximum
+ * flow sends as much as possible from the source to the sink.
+ *
+ * The algorithms run on a residual graph stored in contiguous arrays,
+ * where every edge is paired with a reverse edge with no capacity of its
+ * own: sending flow through an edge gives the same amount of capacity
+ * to its reverse edge, so later steps can undo it.
+ *
+ */
+
+#ifndef INCLUDE_FLOW_H_
+#define INCLUDE_FLOW_H_
+
+#include "graph.h"
+
+
+/* CONSTANTS */
+
+/* Algorithms */
+#define GRAPH_FLOW_DINIC         (0)
+#define GRAPH_FLOW_PUSH_RELABEL  (1)
+
+
+/* DATA STRUCTURES */
+
+/* A maximum flow, and the corresponding minimum cut */
+typedef struct graph_flow {
+    /* Total amount sent from the source to the sink */
+    double value;
+
+    /* Number of edges in the graph */
+    unsigned long n_edges;
+
+    /* Amount sent through each edge. The edges are numbered as in a CSR
+     * snapshot (see graph_freeze): the edges of vertex 0 first, then
+     * those of vertex 1, and so on, each in the order of its list. */
+    double *flow;
+
+    /* Side of the minimum cut each vertex is on: true for the vertices
+     * that can still be reached from the source in the residual graph.
+     * The edges from these vertices to the rest of the graph are the
+     * cut, and their capacities add up to the value of the flow. */
+    bool *source_side;
+} graph_flow_t;
+
+
+/* FUNCTIONS */
+
+/*
+ * Finds a maximum flow from one vertex of a graph to another, and the
+ * minimum cut between them
+ *
+ * Two algorithms are available:
+ *  - GRAPH_FLOW_DINIC: Dinic's algorithm, which repeatedly finds the
+ *    shortest paths from the source to the sink (with a BFS) and sends
+ *    as much flow as they can take (with a DFS). Runs in O(V^2 E) time
+ *    in the worst case, but usually much faster.
+ *  - GRAPH_FLOW_PUSH_RELABEL: The push-relabel algorithm (with a FIFO
+ *    queue of active vertices), which pushes excess flow towards the
+ *    sink along edges that go "downhill". Every now and then, the
+ *    heights of all the vertices are recomputed exactly with a BFS
+ *    (global relabeling), which avoids most of the slow, local
+ *    relabels. Runs in O(V^3) time in the worst case.
+ *
+ * Both find a flow with the same value and the same minimum cut, but
+ * the amounts sent through each edge may differ.
+ *
+ * Parameters:
+ *  - g: The graph. Edge weights are the capacities, and must not be
+ *       negative.
+ *  - source, sink: The numerical indices of the source and the sink
+ *  - algorithm: GRAPH_FLOW_DINIC or GRAPH_FLOW_PUSH_RELABEL
+ *  - flow: The result. Must point to allocated memory, and must be
+ *          freed with graph_flow_free.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: If the source or the sink is invalid
+ *  - EINVAL: If the source and the sink are the same vertex, an edge
+ *            has a negative weight, or the algorithm is unknown
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_max_flow(graph_t *g, unsigned int source, unsigned int sink,
+                   int algorithm, graph_flow_t *flow);
+
+/*
+ * Frees resources associated with a flow
+ *
+ * Parameters:
+ *  - flow: The flow
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int graph_flow_free(graph_flow_t *flow);
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Synthetic graph generators
+ *
+ * These functions build random graphs of a given size, so algorithms can
+ * be tested and benchmarked on inputs much larger than the examples. The
+ * graphs are built directly in a graph_t, and can be saved with
+ * graph_to_file or graph_to_bin.
+ *
+ * Every generator takes a seed, and the same seed always produces the
+ * same graph. Edge weights are integers drawn uniformly between 1 and
+ * GRAPH_GEN_MAX_WEIGHT. The vertices have no labels (graph_to_file
+ * writes their indices instead).
+ *
+ */
+
+#ifndef INCLUDE_GENERATORS_H_
+#define INCLUDE_GENERATORS_H_
+
+#include "graph.h"
+
+
+/* CONSTANTS */
+
+/* Largest edge weight */
+#define GRAPH_GEN_MAX_WEIGHT (100)
+
+/* Default R-MAT probabilities (the ones used by Graph500) */
+#define GRAPH_RMAT_A (0.57)
+#define GRAPH_RMAT_B (0.19)
+#define GRAPH_RMAT_C (0.19)
+
+
+/* FUNCTIONS */
+
+/*
+ * Generates an R-MAT (recursive matrix) graph, a Kronecker graph with
+ * a skewed, power-law-like degree distribution similar to that of
+ * social and web graphs.
+ *
+ * Each edge is placed by recursively splitting the adjacency matrix into
+ * four quadrants, and choosing the top-left, top-right, bottom-left or
+ * bottom-right one with probabilities a, b, c and 1-a-b-c. The vertices
+ * are then shuffled, so the high-degree ones are not all at the lowest
+ * indices. Duplicate edges and loops are kept.
+ *
+ * Parameters:
+ *  - g: The graph to initialize. Must point to allocated memory.
+ *  - scale: The graph has 2^scale vertices (between 1 and 31)
+ *  - edge_factor: The graph has edge_factor * 2^scale edges
+ *  - a, b, c: The quadrant probabilities (see GRAPH_RMAT_A, etc.)
+ *  - seed: The seed for the random number generator
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If the scale or the probabilities are invalid
+ *  - ENOMEM: If there was insufficient memory
+ *
+ *  If an error occurs, the graph is left uninitialized.
+ */
+int graph_gen_rmat(graph_t *g, unsigned int scale, unsigned int edge_factor,
+                   double a, double b, double c, unsigned long seed);
+
+/*
+ * Generates an Erdős–Rényi graph (G(n, m)): n vertices, and m directed
+ * edges between vertices chosen uniformly at random. There are no loops,
+ * but there may be duplicate edges.
+ *
+ * Parameters:
+ *  - g: The graph to initialize. Must point to allocated memory.
+ *  - n: The number of vertices
+ *  - m: The number of edges
+ *  - seed: The seed for the random number generator
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If n is zero, or if n is one and m is not zero
+ *  - ENOMEM: If there was insufficient memory
+ *
+ *  If an error occurs, the graph is left uninitialized.
+ */
+int graph_gen_erdos_renyi(graph_t *g, unsigned int n, unsigned long m, unsigned long seed);
+
+/*
+ * Generates a 2D grid: vertex r*cols+c is connected to the vertices
+ * above, below, left and right of it, with an edge in each direction
+ * (both with the same weight).
+ *
+ * Parameters:
+ *  - g: The graph to initialize. Must point to allocated memory.
+ *  - rows, cols: The size of the grid
+ *  - seed: The seed for the random number generator
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If either dimension is zero, or if the grid has
+ *            GRAPH_NO_VERTEX vertices or more
+ *  - ENOMEM: If there was insufficient memory
+ *
+ *  If an error occurs, the graph is left uninitialized.
+ */
+int graph_gen_grid(graph_t *g, unsigned int rows, unsigned int cols, unsigned long seed);
+
+/*
+ * Generates a DAG with a path through all its vertices (edges from each
+ * vertex i to i+1) plus some edges from random vertices to random
+ * vertices with higher indices. The DAG is as deep as it can be, which
+ * makes it a worst case for recursive traversals and topological sorts.
+ *
+ * Parameters:
+ *  - g: The graph to initialize. Must point to allocated memory.
+ *  - n: The number of vertices
+ *  - extra: The number of edges added to the path
+ *  - seed: The seed for the random number generator
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If n is zero, or if n is one and extra is not zero
+ *  - ENOMEM: If there was insufficient memory
+ *
+ *  If an error occurs, the graph is left uninitialized.
+ */
+int graph_gen_chain_dag(graph_t *g, unsigned int n, unsigned long extra, unsigned long seed);
+
+#endif
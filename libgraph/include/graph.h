@@ -11,6 +11,14 @@
 /* CONSTANTS */
 #define MAX_LABEL_LEN (100)
 
+/* Used in predecessor arrays for vertices without a predecessor,
+ * and in vertex mappings for vertices that don't exist */
+#define GRAPH_NO_VERTEX (~0u)
+
+/* Default out-degree at which a vertex gets an adjacency index
+ * (see graph_set_index_threshold) */
+#define GRAPH_INDEX_THRESHOLD (1024)
+
 /* RESULT CODES */
 #define SUCCESS   (0)
 #define ENOMEM    (-1)
@@ -19,6 +27,7 @@
 #define EFILE     (-4)
 #define EPARSE    (-5)
 #define EINVAL    (-6)
+#define ECYCLE    (-7)
 
 
 #define CHECK_STATUS(rc)  {\
@@ -39,11 +48,31 @@
  * Each vertex has a singly-linked list of edge_t struct, containing
  * information on the vertex's outgoing edges.
  *
+ * The edge_t structs themselves are not allocated one at a time.
+ * Instead, the graph carves them out of larger blocks of memory
+ * (slabs), which are only freed when the whole graph is freed.
+ *
+ * Vertices with many edges also have an adjacency index: a hash table
+ * from target vertices to edges, so checking whether two vertices are
+ * adjacent doesn't require walking the whole list of edges.
+ *
+ * Vertices can be added after the graph is created, which may move the
+ * vertex array (any vertex_t* obtained before then must be fetched again,
+ * but the graph updates its own edges). Removed vertices are left in the
+ * array as isolated, unlabeled "tombstones" until graph_compact is called.
+ * Tombstones can't be given labels or edges, but they still count as
+ * vertices for most algorithms: the traversals, shortest paths and
+ * components see them as isolated vertices (graph_dfs, for instance,
+ * counts each one as a component of its own). Only the MSTs, graph_reorder
+ * and PageRank skip them; call graph_compact first to drop them.
+ *
  */
 
 /* Forward declarations */
 typedef struct vertex vertex_t;
 typedef struct edge edge_t;
+typedef struct edge_slab edge_slab_t;
+typedef struct edge_index edge_index_t;
 
 /* A node in the list of edges */
 typedef struct edge {
@@ -58,6 +87,36 @@ typedef struct edge {
 } edge_t;
 
 
+/* A block of memory for edges */
+typedef struct edge_slab {
+    /* The previously allocated slab (NULL if none) */
+    edge_slab_t* next;
+
+    /* Number of edges in use, and number of edges that fit in the slab */
+    unsigned long used;
+    unsigned long capacity;
+
+    /* The edges themselves */
+    edge_t edges[];
+} edge_slab_t;
+
+
+/* Adjacency index of a vertex: a hash table (open addressing, linear
+ * probing) of the vertex's edges, keyed by the vertex they lead to. If
+ * there are several edges to the same vertex, the index points to the
+ * first one in the list of edges. */
+typedef struct edge_index {
+    /* Number of slots (a power of two) */
+    unsigned int size;
+
+    /* Number of occupied slots */
+    unsigned int count;
+
+    /* The slots (NULL if empty) */
+    edge_t *slots[];
+} edge_index_t;
+
+
 /* A graph vertex */
 typedef struct vertex {
     /* String label for the vertex. Can be NULL. */
@@ -65,6 +124,16 @@ typedef struct vertex {
 
     /* Linked list of edges from this vertex */
     edge_t* edges;
+
+    /* Number of edges in the list */
+    unsigned int degree;
+
+    /* Adjacency index of the edges (NULL if the vertex
+     * doesn't have one) */
+    edge_index_t* index;
+
+    /* Whether the vertex has been removed (see graph_remove_vertex) */
+    bool removed;
 } vertex_t;
 
 
@@ -75,9 +144,78 @@ typedef struct graph {
 
     /* Dynamically allocated array of vertices */
     vertex_t* vertices;
+
+    /* Number of vertices that fit in the array */
+    unsigned int vertices_capacity;
+
+    /* Number of removed vertices still in the array */
+    unsigned int n_removed;
+
+    /* Hash table mapping labels to vertex indices (open addressing,
+     * linear probing). Each slot stores a vertex index plus one, so
+     * zero means the slot is empty. Kept up to date by graph_set_label. */
+    unsigned int *label_map;
+
+    /* Number of other vertices with the label of each slot of label_map
+     * (stored in the same allocation as label_map, right after it) */
+    unsigned int *label_dups;
+
+    /* Number of slots in label_map (always a power of two) */
+    unsigned int label_map_size;
+
+    /* Number of occupied slots in label_map */
+    unsigned int label_map_count;
+
+    /* Slabs the edges are allocated from. The most recently
+     * allocated slab is at the head of the list. */
+    edge_slab_t *edge_slabs;
+
+    /* Edges that have been removed, and can be reused */
+    edge_t *free_edges;
+
+    /* Total number of edges in the graph */
+    unsigned long n_edges;
+
+    /* Out-degree at which vertices get an adjacency index
+     * (0 if no vertex has one) */
+    unsigned int index_threshold;
+
+    /* Incremented every time the graph is modified. Used to detect
+     * when a snapshot of the graph (see csr.h) is out of date. */
+    unsigned long version;
 } graph_t;
 
 
+/* A pair of vertices (see graph_are_adjacent) */
+typedef struct vertex_pair {
+    unsigned int from;
+    unsigned int to;
+} vertex_pair_t;
+
+
+/* Memory used by the edges of a graph (see graph_edge_memory) */
+typedef struct graph_mem_stats {
+    /* Number of edges in the graph */
+    unsigned long n_edges;
+
+    /* Number of slabs allocated */
+    unsigned long n_slabs;
+
+    /* Bytes allocated for slabs (including unused edges at
+     * the end of the most recent slab) */
+    size_t arena_bytes;
+
+    /* Estimate of the bytes that allocating each edge separately
+     * would take (including per-allocation overhead) */
+    size_t malloc_bytes;
+
+    /* Number of vertices with an adjacency index, and bytes
+     * allocated for the indexes */
+    unsigned int n_indexes;
+    size_t index_bytes;
+} graph_mem_stats_t;
+
+
 /* FUNCTIONS */
 
 /*
@@ -131,6 +269,7 @@ int graph_print(graph_t *g);
  *  - 0 on success
  *  - ENOMEM: If there was insufficient memory
  *  - EINDEX: If the provided index is invalid
+ *  - ENOTFOUND: If the vertex has been removed
  *
  */
 int graph_set_label(graph_t *g, unsigned int i, const char *label);
@@ -175,10 +314,28 @@ long int graph_vertex_index(graph_t *g, vertex_t *v);
  * Returns:
  *  - 0 on success
  *  - EINDEX: If one of the provided indices is invalid
+ *  - ENOTFOUND: If one of the vertices has been removed
  *  - ENOMEM: If there was insufficient memory
  */
 int graph_add_edge(graph_t *g, unsigned int from, unsigned int to, double weight);
 
+/*
+ * Reserves memory for edges that will be added to a graph
+ *
+ * Adding edges never requires calling this function, but if the number
+ * of edges is known in advance, reserving memory for all of them
+ * at once avoids allocating several smaller slabs.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - n: The number of edges that will be added
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_reserve_edges(graph_t *g, unsigned long n);
+
 /*
  * Checks whether two vertices are adjacent
  *
@@ -196,6 +353,42 @@ int graph_add_edge(graph_t *g, unsigned int from, unsigned int to, double weight
  */
 int graph_is_vertex_adjacent(graph_t *g, unsigned int from, unsigned int to, double *weight);
 
+/*
+ * Checks whether several pairs of vertices are adjacent
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - pairs: Array of n pairs of numerical vertex indices
+ *  - n: The number of pairs
+ *  - out: Output parameter. Must point to an array of n ints, where
+ *         out[k] is set to what graph_is_vertex_adjacent returns for
+ *         pairs[k] (0, 1 or EINDEX).
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int graph_are_adjacent(graph_t *g, const vertex_pair_t *pairs, unsigned long n, int *out);
+
+/*
+ * Sets the out-degree at which vertices get an adjacency index, and
+ * builds or frees indexes accordingly. An index makes
+ * graph_is_vertex_adjacent take constant time on average instead of time
+ * proportional to the degree of the vertex, and uses between 16 and 32
+ * bytes per edge of the vertex. Graphs start with a threshold of
+ * GRAPH_INDEX_THRESHOLD.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - threshold: The out-degree at which vertices get an index
+ *               (0 to not index any vertex)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory (vertices whose index
+ *    could not be built are left without one)
+ */
+int graph_set_index_threshold(graph_t *g, unsigned int threshold);
+
 
 /*
  * Computes the number of vertices with a self-edge
@@ -209,6 +402,116 @@ int graph_is_vertex_adjacent(graph_t *g, unsigned int from, unsigned int to, dou
 int graph_num_vertex_with_loops(graph_t *g);
 
 
+/*
+ * Reports how much memory the edges of a graph use
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - stats: Out parameter. Must point to a graph_mem_stats_t.
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int graph_edge_memory(graph_t *g, graph_mem_stats_t *stats);
+
+
+/*
+ * Adds a vertex to a graph. The vertex array grows geometrically, so
+ * adding n vertices takes amortized O(1) time each (plus a pass over the
+ * edges every time the array moves). Pointers to vertices obtained before
+ * calling this function may become invalid.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - label: The label of the new vertex (can be NULL)
+ *  - index: Output parameter. Must either be NULL, or point to an
+ *           unsigned int where the index of the new vertex is stored.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_add_vertex(graph_t *g, const char *label, unsigned int *index);
+
+/*
+ * Removes an edge from a graph. If there are several edges between
+ * the two vertices, the one graph_is_vertex_adjacent finds is removed.
+ * Takes time proportional to the degree of vertex "from".
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - from, to: The numerical indices of the vertices
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: If one of the provided indices is invalid
+ *  - ENOTFOUND: If there is no edge going from "from" to "to" (which
+ *               is always the case if one of the vertices has been removed)
+ */
+int graph_remove_edge(graph_t *g, unsigned int from, unsigned int to);
+
+/*
+ * Removes a vertex from a graph, along with its label and all the
+ * edges from and to it. The vertex is left in the vertex array as a
+ * tombstone (with its 'removed' field set), so the indices of the other
+ * vertices don't change. Takes O(V+E) time, since finding the edges to
+ * the vertex requires going over every list of edges.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - i: The numerical index of the vertex
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: If the provided index is invalid
+ *  - ENOTFOUND: If the vertex had already been removed
+ */
+int graph_remove_vertex(graph_t *g, unsigned int i);
+
+/*
+ * Compacts a graph: drops removed vertices (renumbering the remaining
+ * ones, in the same relative order), and moves the edges into a single
+ * contiguous block, freeing the memory of removed edges. Pointers to
+ * vertices and edges obtained before calling this function become invalid.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - old_to_new: Output parameter. Must either be NULL, or point to an
+ *                array with one entry per vertex in the graph before
+ *                compacting, where the new index of each vertex is
+ *                stored (GRAPH_NO_VERTEX for removed vertices).
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory (if this happens before
+ *    the graph is modified, the graph is left as it was)
+ */
+int graph_compact(graph_t *g, unsigned int *old_to_new);
+
+/*
+ * Renumbers the vertices of a graph, and moves the edges into a single
+ * contiguous block (like graph_compact, but removed vertices are kept,
+ * and renumbered like the rest). The edges of each vertex are stored
+ * together, in the order of the new indices, so traversals that visit
+ * the vertices in roughly that order read the edges sequentially.
+ * Labels stay with their vertices. Pointers to vertices and edges
+ * obtained before calling this function become invalid.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - old_to_new: The new index of each vertex. Must be a permutation
+ *                of the indices between 0 and g->n_vertices-1.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If old_to_new is not a permutation (the graph is left
+ *            as it was)
+ *  - ENOMEM: If there was insufficient memory (if this happens before
+ *    the graph is modified, the graph is left as it was)
+ */
+int graph_permute(graph_t *g, const unsigned int *old_to_new);
+
+
 /*
  * Loads a graph from a file
  *
@@ -224,6 +527,44 @@ int graph_num_vertex_with_loops(graph_t *g);
  */
 int graph_from_file(graph_t *g, const char *filename);
 
+/*
+ * Loads a graph from a file, like graph_from_file, but memory-maps the
+ * file and parses it in place. This is considerably faster on large files.
+ *
+ * Parameters:
+ *  - g: The graph to initialize. Must point to allocated memory.
+ *  - filename: The file containing the graph specification.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ *  - EFILE: Error when opening/reading the file
+ *  - EPARSE: If the graph file could not be parsed
+ *
+ *  If an error occurs, the graph is left uninitialized.
+ */
+int graph_from_file_mmap(graph_t *g, const char *filename);
+
+/*
+ * Saves a graph to a text file, in the format read by graph_from_file.
+ * The file always describes a directed graph (an undirected graph
+ * is written with both directions of every edge).
+ *
+ * Vertices without labels, including removed vertices, are written with
+ * their index as their label, so the labels in the file are only unique
+ * if no other vertex has a label that is a number. Labels must not
+ * contain whitespace.
+ *
+ * Parameters:
+ *  - g: The graph to save.
+ *  - filename: The file to save to
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EFILE: Error when opening/writing the file
+ */
+int graph_to_file(graph_t *g, const char *filename);
+
 /*
  * Saves a graph to a .dot file
  *
@@ -243,6 +584,54 @@ int graph_from_file(graph_t *g, const char *filename);
  */
 int graph_to_dot(graph_t *g, const char *filename, bool undirected, bool weights);
 
+/*
+ * Saves a graph to a binary file
+ *
+ * The binary format stores the edges in CSR form (see csr.h), along with
+ * a pool of vertex labels, so it can be loaded with almost no parsing.
+ * Numbers are stored in the byte order of the machine that wrote the file.
+ *
+ * Parameters:
+ *  - g: The graph to save.
+ *  - filename: The file to save to
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ *  - EFILE: Error when opening/writing the file
+ */
+int graph_to_bin(graph_t *g, const char *filename);
+
+/*
+ * Loads a graph from a binary file created by graph_to_bin
+ *
+ * Parameters:
+ *  - g: The graph to initialize. Must point to allocated memory.
+ *  - filename: The binary file
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ *  - EFILE: Error when opening/reading the file
+ *  - EPARSE: If the file is not a valid binary graph file
+ *
+ *  If an error occurs, the graph is left uninitialized.
+ */
+int graph_from_bin(graph_t *g, const char *filename);
+
+/*
+ * Loads a graph from a file, which can be either a binary file
+ * (see graph_to_bin) or a text file (see graph_from_file)
+ *
+ * Parameters:
+ *  - g: The graph to initialize. Must point to allocated memory.
+ *  - filename: The file
+ *
+ * Returns:
+ *  - Same as graph_from_bin or graph_from_file_mmap
+ */
+int graph_load(graph_t *g, const char *filename);
+
 
 /* BY-LABEL FUNCTIONS
  *
@@ -251,6 +640,9 @@ int graph_to_dot(graph_t *g, const char *filename, bool undirected, bool weights
  *
  * Instead of EINDEX, they return ENOTFOUND if either of the string labels is NULL
  * or does not have a corresponding vertex.
+ *
+ * Labels are looked up in a hash table (see graph_t), so these functions
+ * take expected constant time regardless of the number of vertices.
  */
 int graph_get_vertex_lbl(graph_t *g, const char *label, vertex_t **v);
 int graph_add_edge_lbl(graph_t *g, const char *from, const char *to, double weight);
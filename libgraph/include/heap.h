@@ -0,0 +1,138 @@
+/*
+ * Indexed d-ary min-heap
+ *
+ * This module provides a priority queue of items identified by integers
+ * between 0 and capacity-1 (typically, vertex indices), ordered by a key
+ * of type double. Since the heap keeps track of where each item is, the
+ * key of an item can be decreased in O(log n) time, which is what
+ * algorithms like Dijkstra's and Prim's need.
+ *
+ * Each node of the heap has d children. Larger values of d make the
+ * heap shallower, which speeds up decrease-key operations (and improves
+ * cache behaviour) at the cost of slightly slower removals.
+ *
+ */
+
+#ifndef INCLUDE_HEAP_H_
+#define INCLUDE_HEAP_H_
+
+#include "graph.h"
+#include "vlist.h"
+
+
+/* CONSTANTS */
+
+/* Arity used if none is specified */
+#define IHEAP_DEFAULT_ARITY (4)
+
+/* Position of an item that is not in the heap */
+#define IHEAP_NOT_IN_HEAP (~0u)
+
+
+/* DATA STRUCTURES */
+
+/* An entry in the heap */
+typedef struct iheap_entry {
+    double key;
+    unsigned int id;
+} iheap_entry_t;
+
+/* The heap */
+typedef struct iheap {
+    /* Number of children of each node */
+    unsigned int d;
+
+    /* Number of items in the heap */
+    unsigned int size;
+
+    /* Items must be between 0 and capacity-1 */
+    unsigned int capacity;
+
+    /* Array of capacity entries, organized as a heap */
+    iheap_entry_t *entries;
+
+    /* Position of each item in 'entries' (or IHEAP_NOT_IN_HEAP) */
+    unsigned int *pos;
+} iheap_t;
+
+
+/*
+ * Initializes a heap
+ *
+ * Parameters:
+ *  - h: The heap to initialize. Must point to allocated memory.
+ *  - capacity: Items will be between 0 and capacity-1
+ *  - d: Number of children of each node (0 for IHEAP_DEFAULT_ARITY)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int iheap_init(iheap_t *h, unsigned int capacity, unsigned int d);
+
+/*
+ * Frees resources associated with a heap
+ *
+ * Parameters:
+ *  - h: The heap
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int iheap_free(iheap_t *h);
+
+/*
+ * Removes every item from a heap (in time proportional to
+ * the number of items in the heap, not its capacity)
+ *
+ * Parameters:
+ *  - h: The heap
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int iheap_clear(iheap_t *h);
+
+/*
+ * Checks whether an item is in a heap
+ *
+ * Parameters:
+ *  - h: The heap
+ *  - id: The item
+ *
+ * Returns:
+ *  - true if the item is in the heap, false otherwise
+ */
+bool iheap_contains(iheap_t *h, unsigned int id);
+
+/*
+ * Inserts an item into the heap or, if it is already in the heap,
+ * decreases its key (if the new key is not smaller than the current
+ * one, the heap is not modified)
+ *
+ * Parameters:
+ *  - h: The heap
+ *  - id: The item
+ *  - key: The key
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINDEX: If the item is not smaller than the heap's capacity
+ */
+int iheap_push(iheap_t *h, unsigned int id, double key);
+
+/*
+ * Removes the item with the smallest key from the heap
+ *
+ * Parameters:
+ *  - h: The heap
+ *  - id: Out parameter for the item
+ *  - key: Out parameter for its key (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EEMPTY: If the heap is empty
+ */
+int iheap_pop(iheap_t *h, unsigned int *id, double *key);
+
+#endif
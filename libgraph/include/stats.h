@@ -0,0 +1,86 @@
+/*
+ * Per-call statistics
+ *
+ * When libgraph is built with the LIBGRAPH_ENABLE_STATS CMake option
+ * (which defines GRAPH_ENABLE_STATS), the loaders and the single-threaded
+ * algorithms count the work they do: the vertices they visit, the edges
+ * they scan, the memory allocations made along the way (by the function
+ * itself, and by vlist, vdeque, workspaces and the graph, for instance
+ * in graph_add_edge), the largest number of vertices waiting in their
+ * queue or stack, and the time they take. The counters of the last
+ * instrumented call made by each thread can then be retrieved with
+ * graph_stats_last.
+ *
+ * This tells apart calls that are dominated by loading, by allocation
+ * or by traversing edges, and gives traversed edges per second (TEPS)
+ * directly. Without the option, the counters compile to nothing and
+ * graph_stats_last fails, so the algorithms run at full speed.
+ *
+ * The instrumented functions are graph_from_file, graph_from_file_mmap,
+ * graph_from_bin, graph_bfs_traverse, graph_dfs_traverse,
+ * graph_dfs_iter_traverse, graph_toposort_ws, graph_spanning_tree_traverse,
+ * graph_csr_bfs_traverse, graph_csr_msbfs, graph_shortest_paths, graph_shortest_path,
+ * graph_toposort_kahn, graph_connected_components and graph_scc, along
+ * with the functions that call them (such as graph_bfs or graph_load).
+ * Multithreaded algorithms are not instrumented, since their worker
+ * threads would each have their own counters.
+ *
+ */
+
+#ifndef INCLUDE_STATS_H_
+#define INCLUDE_STATS_H_
+
+#include "graph.h"
+
+
+/* DATA STRUCTURES */
+
+/* Statistics of a call */
+typedef struct graph_stats {
+    /* Name of the instrumented function */
+    const char *function;
+
+    /* Number of vertices visited, and number of edges scanned */
+    unsigned long vertices_visited;
+    unsigned long edges_scanned;
+
+    /* Number of memory allocations */
+    unsigned long allocations;
+
+    /* Largest number of vertices in the queue or stack at once */
+    unsigned long queue_max;
+
+    /* Wall-clock time, in seconds */
+    double seconds;
+} graph_stats_t;
+
+
+/* FUNCTIONS */
+
+/*
+ * Gets the statistics of the last instrumented call made by the
+ * calling thread
+ *
+ * Parameters:
+ *  - stats: Out parameter for the statistics
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOTFOUND: If the thread has not made any instrumented calls yet
+ *  - EINVAL: If libgraph was built without LIBGRAPH_ENABLE_STATS
+ */
+int graph_stats_last(graph_stats_t *stats);
+
+/*
+ * Computes the traversed edges per second (TEPS) of a call
+ *
+ * Parameters:
+ *  - stats: The statistics of the call
+ *
+ * Returns:
+ *  - The number of edges scanned per second (0 if the call
+ *    took no measurable time)
+ */
+double graph_stats_teps(const graph_stats_t *stats);
+
+#endif
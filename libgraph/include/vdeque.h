@@ -0,0 +1,133 @@
+/*
+ * Deque of vertex indices
+ *
+ * This module provides a double-ended queue of vertex indices, stored
+ * in a growable ring buffer. It supports the same operations as vlist_t,
+ * but since the vertices are stored contiguously, inserting and removing
+ * vertices doesn't allocate or free any memory (except when the buffer
+ * has to grow, which happens a logarithmic number of times).
+ *
+ */
+
+#ifndef INCLUDE_VDEQUE_H_
+#define INCLUDE_VDEQUE_H_
+
+#include "graph.h"
+#include "vlist.h"
+
+
+/* DATA STRUCTURES */
+
+/* Deque container */
+typedef struct vdeque {
+    /* Length of the deque */
+    unsigned int length;
+
+    /* Number of indices that fit in the buffer (a power of two) */
+    unsigned int capacity;
+
+    /* Position of the head index in the buffer */
+    unsigned int head;
+
+    /* Ring buffer of vertex indices */
+    unsigned int *items;
+} vdeque_t;
+
+
+/*
+ * Initializes a deque
+ *
+ * Parameters:
+ *  - q: The deque to initialize. Must point to allocated memory.
+ *  - capacity: Number of indices to allocate space for initially
+ *    (the deque grows as needed, so this can be zero)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int vdeque_init(vdeque_t *q, unsigned int capacity);
+
+/*
+ * Frees resources associated with a deque
+ *
+ * Parameters:
+ *  - q: The deque
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int vdeque_free(vdeque_t *q);
+
+/*
+ * Removes every index from a deque (keeping its buffer)
+ *
+ * Parameters:
+ *  - q: The deque
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int vdeque_clear(vdeque_t *q);
+
+/*
+ * Inserts a vertex index at the head/tail of the deque
+ *
+ * Parameters:
+ *  - q: The deque
+ *  - i: The vertex index to insert
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int vdeque_insert_head(vdeque_t *q, unsigned int i);
+int vdeque_insert_tail(vdeque_t *q, unsigned int i);
+
+/*
+ * Removes the vertex index at the head/tail of the deque
+ * and returns its value.
+ *
+ * Parameters:
+ *  - q: The deque
+ *  - i: Out parameter to return the vertex index (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EEMPTY: If the deque was empty (nothing to return)
+ */
+int vdeque_remove_head(vdeque_t *q, unsigned int *i);
+int vdeque_remove_tail(vdeque_t *q, unsigned int *i);
+
+/* Same as vdeque_remove_head and vdeque_remove_tail but
+ * without removing the index from the deque (it just returns
+ * its value) */
+int vdeque_peek_head(vdeque_t *q, unsigned int *i);
+int vdeque_peek_tail(vdeque_t *q, unsigned int *i);
+
+
+/* Functions for interacting with the deque as a queue
+ * (these behave like vlist_enqueue and vlist_dequeue)
+ *
+ * - vdeque_enqueue calls vdeque_insert_head and
+ *   behaves in the same way
+ * - vdeque_dequeue calls vdeque_remove_tail and
+ *   behaves in the same way
+ */
+int vdeque_enqueue(vdeque_t *q, unsigned int i);
+int vdeque_dequeue(vdeque_t *q, unsigned int *i);
+
+
+/* Functions for interacting with the deque as a stack
+ * (these behave like vlist_push and vlist_pop)
+ *
+ * - vdeque_push calls vdeque_insert_head and
+ *   behaves in the same way
+ * - vdeque_pop calls vdeque_remove_head and
+ *   behaves in the same way
+ */
+int vdeque_push(vdeque_t *q, unsigned int i);
+int vdeque_pop(vdeque_t *q, unsigned int *i);
+
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Traversal workspaces
+ *
+ * A workspace holds the memory a traversal needs besides its results:
+ * a set of visited vertices, a queue and a stack, and a few per-vertex
+ * scratch arrays. Traversals that are given a workspace (through the
+ * 'ws' field of graph_traversal_t, or the ws parameter of functions
+ * like graph_toposort_ws) use it instead of allocating their own memory,
+ * so doing many traversals of the same graph with the same workspace
+ * allocates nothing after the first one.
+ *
+ * The visited set is a bitset with one bit per vertex. Instead of
+ * clearing the whole bitset before each traversal, every 64-bit word
+ * records the "epoch" in which it was last written, and resetting the
+ * set just starts a new epoch: words from older epochs are treated
+ * as empty. Resetting is therefore O(1).
+ *
+ * A workspace must not be used by two traversals at the same time.
+ *
+ */
+
+#ifndef INCLUDE_WORKSPACE_H_
+#define INCLUDE_WORKSPACE_H_
+
+#include <stdint.h>
+#include "graph.h"
+#include "vdeque.h"
+
+
+/* DATA STRUCTURES */
+
+/* A traversal workspace */
+typedef struct graph_workspace {
+    /* Number of vertices the workspace has room for */
+    unsigned int capacity;
+
+    /* Visited set: one bit per vertex, and the epoch in which
+     * each word of bits was last written */
+    uint64_t *bits;
+    unsigned int *epochs;
+    unsigned int epoch;
+
+    /* Scratch arrays of 'capacity' entries. Their contents are
+     * undefined at the start of a traversal. */
+    unsigned int *depth;
+    unsigned int *parent;
+    edge_t **next_edge;
+
+    /* Queue and stack of vertex indices */
+    vdeque_t queue;
+    vdeque_t stack;
+} graph_workspace_t;
+
+
+/* FUNCTIONS */
+
+/*
+ * Initializes a workspace
+ *
+ * Parameters:
+ *  - ws: The workspace to initialize. Must point to allocated memory.
+ *  - n: Number of vertices to make room for (the workspace grows
+ *       as needed, but growing it allocates memory)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_workspace_init(graph_workspace_t *ws, unsigned int n);
+
+/*
+ * Frees resources associated with a workspace
+ *
+ * Parameters:
+ *  - ws: The workspace
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+int graph_workspace_free(graph_workspace_t *ws);
+
+/*
+ * Prepares a workspace for a traversal of a graph: empties the visited
+ * set, the queue and the stack, and makes room for the graph's vertices
+ * if needed.
+ *
+ * Parameters:
+ *  - ws: The workspace
+ *  - n: Number of vertices in the graph
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int graph_workspace_reset(graph_workspace_t *ws, unsigned int n);
+
+/*
+ * Checks whether a vertex is in a workspace's visited set
+ *
+ * Parameters:
+ *  - ws: The workspace
+ *  - i: The vertex index (must be less than ws->capacity)
+ *
+ * Returns:
+ *  - true if the vertex has been marked as visited since the
+ *    last reset, false otherwise
+ */
+static inline bool graph_workspace_visited(graph_workspace_t *ws, unsigned int i)
+{
+    unsigned int w = i / 64;
+
+    return ws->epochs[w] == ws->epoch && ((ws->bits[w] >> (i % 64)) & 1);
+}
+
+/*
+ * Adds a vertex to a workspace's visited set
+ *
+ * Parameters:
+ *  - ws: The workspace
+ *  - i: The vertex index (must be less than ws->capacity)
+ */
+static inline void graph_workspace_visit(graph_workspace_t *ws, unsigned int i)
+{
+    unsigned int w = i / 64;
+
+    /* Words from an older epoch are empty */
+    if(ws->epochs[w] != ws->epoch)
+    {
+        ws->epochs[w] = ws->epoch;
+        ws->bits[w] = 0;
+    }
+
+    ws->bits[w] |= UINT64_C(1) << (i % 64);
+}
+
+#endif
@@ -1,327 +1,1121 @@
 #include "algorithms.h"
+#include "vdeque.h"
+#include "workspace.h"
+#include "counters.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
 
 
+/*
+ * Visitor used by the printing traversals: prints a vertex
+ */
+static int print_vertex(graph_t *g, unsigned int i, unsigned int parent, void *arg)
+{
+    char *label = g->vertices[i].label;
+
+    (void) parent;
+    (void) arg;
+
+    printf("%i: %s\n", i, label? label : "NO LABEL");
+
+    return SUCCESS;
+}
+
+
+/*
+ * Visitor used by the printing traversals of CSR snapshots: prints a
+ * vertex, with its label in the snapshot passed as 'arg'
+ */
+static int print_csr_vertex(graph_t *g, unsigned int i, unsigned int parent, void *arg)
+{
+    graph_csr_t *csr = arg;
+
+    (void) g;
+    (void) parent;
+
+    printf("%i: %s\n", i, csr->labels[i]? csr->labels[i] : "NO LABEL");
+
+    return SUCCESS;
+}
+
+
+/*
+ * Visitor used by graph_spanning_tree and graph_csr_spanning_tree:
+ * prints the tree edge through which a vertex was reached
+ */
+static int print_tree_edge(graph_t *g, unsigned int i, unsigned int parent, void *arg)
+{
+    (void) g;
+    (void) arg;
+
+    if(parent != GRAPH_NO_VERTEX)
+        printf("%i %i\n", parent, i);
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: prepares a traversal struct before a traversal
+ *
+ * Parameters:
+ *  - n: The number of vertices in the graph (or snapshot)
+ *  - t: The traversal (can be NULL)
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+static int traversal_begin(unsigned int n, graph_traversal_t *t)
+{
+    if(t == NULL)
+        return SUCCESS;
+
+    t->n_visited = 0;
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        if(t->parent != NULL)
+            t->parent[i] = GRAPH_NO_VERTEX;
+        if(t->depth != NULL)
+            t->depth[i] = GRAPH_NO_VERTEX;
+    }
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: records that a traversal has visited a vertex,
+ * and calls the visitor function
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - t: The traversal (can be NULL)
+ *  - i: The vertex
+ *  - parent: The vertex from which i was reached (GRAPH_NO_VERTEX
+ *            if i is where the traversal started)
+ *  - depth: Depth of i in the traversal tree
+ *
+ * Returns:
+ *  - The value returned by the visitor function (or 0 if there is none)
+ */
+static int traversal_visit(graph_t *g, graph_traversal_t *t, unsigned int i,
+                           unsigned int parent, unsigned int depth)
+{
+    STATS_VERTICES(1);
+
+    if(t == NULL)
+        return SUCCESS;
+
+    if(t->order != NULL)
+        t->order[t->n_visited] = i;
+    if(t->parent != NULL)
+        t->parent[i] = parent;
+    if(t->depth != NULL)
+        t->depth[i] = depth;
+    t->n_visited++;
+
+    if(t->visit != NULL)
+        return t->visit(g, i, parent, t->arg);
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: gets the workspace to use for a traversal
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - ws: The workspace provided by the caller (can be NULL)
+ *  - tmp: A workspace to initialize if the caller did not provide one
+ *  - out: Out parameter for the workspace to use (either ws or tmp),
+ *         which must be released with workspace_end
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int workspace_begin(graph_t *g, graph_workspace_t *ws, graph_workspace_t *tmp,
+                           graph_workspace_t **out)
+{
+    if(ws == NULL)
+    {
+        *out = tmp;
+        return graph_workspace_init(tmp, g->n_vertices);
+    }
+
+    *out = ws;
+    return graph_workspace_reset(ws, g->n_vertices);
+}
+
+
+/*
+ * Helper function: releases the workspace used by a traversal
+ *
+ * Parameters:
+ *  - ws: The workspace returned by workspace_begin
+ *  - tmp: The temporary workspace passed to workspace_begin
+ */
+static void workspace_end(graph_workspace_t *ws, graph_workspace_t *tmp)
+{
+    if(ws == tmp)
+        graph_workspace_free(tmp);
+}
+
+
 /* See algorithms.h */
-int graph_bfs(graph_t *g, unsigned int start)
+int graph_bfs_traverse(graph_t *g, unsigned int start, graph_traversal_t *t)
 {
     int rc;
-    bool *visited;
-    vertex_t *v_start;
-    vlist_t queue;
+    graph_workspace_t tmp, *ws;
 
-    /* Create boolean array to keep track of what vertices
-     * have been visited */
-    visited = calloc(g->n_vertices, sizeof(bool));
-    if(visited == NULL)
-        return ENOMEM;
+    if(start >= g->n_vertices)
+        return EINDEX;
 
-    /* Create queue */
-    rc = vlist_init(&queue);
-    if(rc != SUCCESS)
-        return rc;
+    STATS_BEGIN();
 
-    /* Get the start vertex. Enqueue it and mask it as visited */
-    rc = graph_get_vertex(g, start, &v_start);
+    /* The workspace has the set of visited vertices, an array
+     * with their depth, and the queue */
+    rc = workspace_begin(g, t != NULL ? t->ws : NULL, &tmp, &ws);
     if(rc != SUCCESS)
+    {
+        STATS_END();
         return rc;
-    vlist_enqueue(&queue, v_start);
-    visited[start] = true;
+    }
 
-    while(queue.length > 0)
+    vdeque_t *queue = &ws->queue;
+    unsigned int *depth = ws->depth;
+
+    traversal_begin(g->n_vertices, t);
+
+    /* Enqueue the start vertex and mark it as visited */
+    vdeque_enqueue(queue, start);
+    graph_workspace_visit(ws, start);
+    depth[start] = 0;
+
+    rc = traversal_visit(g, t, start, GRAPH_NO_VERTEX, 0);
+
+    while(rc == SUCCESS && queue->length > 0)
     {
         /* Dequeue a vertex from the queue*/
-        vertex_t *v;
-        rc = vlist_dequeue(&queue, &v);
-        assert(rc == SUCCESS);
-
-        /* Process the vertex (we just print it) */
-        int i = graph_vertex_index(g, v);
-        assert(i >= 0);
-        printf("%i: %s\n", i, v->label? v->label : "NO LABEL");
+        unsigned int i;
+        vdeque_dequeue(queue, &i);
 
         /* Iterate over the edges of the vertex */
-        edge_t *e = v->edges;
-        while(e != NULL)
+        edge_t *e = g->vertices[i].edges;
+        STATS_EDGES(g->vertices[i].degree);
+        while(e != NULL && rc == SUCCESS)
         {
-            vertex_t *v_next = e->to;
-            int i_next = graph_vertex_index(g, v_next);
+            int i_next = graph_vertex_index(g, e->to);
             assert(i_next >= 0);
 
             /* Process the vertex if we haven't already visited it */
-            if(!visited[i_next])
+            if(!graph_workspace_visited(ws, i_next))
             {
-                visited[i_next] = true;
-                rc = vlist_enqueue(&queue, v_next);
+                graph_workspace_visit(ws, i_next);
+                depth[i_next] = depth[i] + 1;
+                rc = vdeque_enqueue(queue, i_next);
+
+                if(rc == SUCCESS)
+                    rc = traversal_visit(g, t, i_next, i, depth[i_next]);
             }
 
             e = e->next;
         }
-
-        assert(rc == SUCCESS);
     }
 
-    return SUCCESS;
+    workspace_end(ws, &tmp);
+
+    STATS_END();
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_bfs(graph_t *g, unsigned int start)
+{
+    graph_traversal_t t = { .visit = print_vertex };
+
+    return graph_bfs_traverse(g, start, &t);
 }
 
 
 /*
- * This is the recursive implementation of DFS, called
- * by graph_dfs.
+ * This is the DFS from a single vertex, called by graph_dfs_traverse.
+ * Instead of recursing, it keeps a stack of vertices, and remembers
+ * the next edge to explore from each vertex in the stack, so it visits
+ * the vertices in the same order as a recursive DFS would.
  *
  * Parameters:
  *  - g: The graph
- *  - i: The numerical index of the vertex to start with
- *  - visited: boolean array of visited vertices
+ *  - root: The numerical index of the vertex to start with
+ *          (already marked as visited)
+ *  - ws: The workspace
+ *  - t: The traversal (can be NULL)
  *
  * Returns:
- *  - Always returns 0
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ *  - Otherwise, the value returned by the visitor function
+ *    that stopped the traversal
  */
-static int graph_dfs_visit(graph_t *g, unsigned int i, bool *visited)
+static int graph_dfs_visit(graph_t *g, unsigned int root, graph_workspace_t *ws,
+                           graph_traversal_t *t)
 {
     int rc;
-    vertex_t *v;
+    vdeque_t *stack = &ws->stack;
+
+    vdeque_clear(stack);
 
-    /* Get the vertex and process it */
-    rc = graph_get_vertex(g, i, &v);
+    rc = traversal_visit(g, t, root, GRAPH_NO_VERTEX, 0);
     if(rc != SUCCESS)
         return rc;
-    printf("%i: %s\n", i, v->label? v->label : "NO LABEL");
 
-    /* Iterate over the edges of the vertex */
-    edge_t *e = v->edges;
-    while(e != NULL)
+    ws->depth[root] = 0;
+    ws->next_edge[root] = g->vertices[root].edges;
+    STATS_EDGES(g->vertices[root].degree);
+    rc = vdeque_push(stack, root);
+
+    while(rc == SUCCESS && stack->length > 0)
     {
+        unsigned int i;
+        vdeque_peek_head(stack, &i);
+
+        edge_t *e = ws->next_edge[i];
+
+        /* Every edge of i has been explored */
+        if(e == NULL)
+        {
+            vdeque_pop(stack, NULL);
+            continue;
+        }
+
+        ws->next_edge[i] = e->next;
+
         int i_next = graph_vertex_index(g, e->to);
         assert(i_next >= 0);
 
-        /* If we haven't visited the next vertex, recursively process it*/
-        if(!visited[i_next])
+        /* If we haven't visited the next vertex, process it
+         * and continue the DFS from it */
+        if(!graph_workspace_visited(ws, i_next))
         {
-            visited[i_next] = true;
-            rc = graph_dfs_visit(g, i_next, visited);
-            assert(rc == SUCCESS);
+            graph_workspace_visit(ws, i_next);
+            ws->depth[i_next] = ws->depth[i] + 1;
+            ws->next_edge[i_next] = g->vertices[i_next].edges;
+            STATS_EDGES(g->vertices[i_next].degree);
+
+            rc = traversal_visit(g, t, i_next, i, ws->depth[i_next]);
+            if(rc == SUCCESS)
+                rc = vdeque_push(stack, i_next);
         }
-
-        e = e->next;
     }
 
-    return SUCCESS;
+    return rc;
 }
 
 
 /* See algorithms.h */
-int graph_dfs(graph_t *g, unsigned int start)
+int graph_dfs_traverse(graph_t *g, unsigned int start, graph_traversal_t *t,
+                       unsigned int *n_components)
 {
-    /* Create boolean array to keep track of what vertices
-     * have been visited */
-    bool *visited = calloc(g->n_vertices, sizeof(bool));
+    int rc;
+    graph_workspace_t tmp, *ws;
 
-    /* Mark start vertex visited */
-    visited[start] = true;
+    if(start >= g->n_vertices)
+        return EINDEX;
 
-    /* Make first call to recursive DFS function */
-    int rc;
-    rc = graph_dfs_visit(g, start, visited);
+    STATS_BEGIN();
+
+    rc = workspace_begin(g, t != NULL ? t->ws : NULL, &tmp, &ws);
     if(rc != SUCCESS)
+    {
+        STATS_END();
         return rc;
+    }
+
+    traversal_begin(g->n_vertices, t);
+
+    /* Mark start vertex visited */
+    graph_workspace_visit(ws, start);
+
+    /* Do a DFS from the start vertex */
+    rc = graph_dfs_visit(g, start, ws, t);
 
     unsigned int connected = 1;
 
-    for(unsigned int i=0; i < g->n_vertices; i++)
-        if(!visited[i])
+    for(unsigned int i=0; rc == SUCCESS && i < g->n_vertices; i++)
+        if(!graph_workspace_visited(ws, i))
         {
             connected++;
-            rc = graph_dfs_visit(g, i, visited);
-            assert(rc == SUCCESS);
+            graph_workspace_visit(ws, i);
+            rc = graph_dfs_visit(g, i, ws, t);
         }
 
+    workspace_end(ws, &tmp);
+
+    STATS_END();
+
+    if(rc == SUCCESS && n_components != NULL)
+        *n_components = connected;
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_dfs(graph_t *g, unsigned int start)
+{
+    graph_traversal_t t = { .visit = print_vertex };
+    unsigned int connected;
+    int rc;
+
+    rc = graph_dfs_traverse(g, start, &t, &connected);
+    if(rc != SUCCESS)
+        return rc;
+
     return connected;
 }
 
 
-/*
- * This is the recursive implementation of toposort, called
- * by graph_toposort.
- *
- * Parameters:
- *  - g: The graph
- *  - i: The numerical index of the vertex to start with
- *  - visited: boolean array of visited vertices
- *  - l: the list of vertices to be returned. Assumed to be
- *       initialized by graph_toposort
- *
- * Returns:
- *  - Always returns 0
- */
-static int graph_toposort_visit(graph_t *g, unsigned int i, bool *visited, vlist_t *l)
+/* See algorithms.h */
+int graph_toposort_ws(graph_t *g, unsigned int start, vlist_t **l, graph_workspace_t *ws)
 {
+    graph_workspace_t tmp;
     int rc;
-    vertex_t *v;
 
-    rc = graph_get_vertex(g, i, &v);
+    if(start >= g->n_vertices)
+        return EINDEX;
+
+    STATS_BEGIN();
+
+    /* Instead of recursing, we keep a stack of vertices, and remember
+     * the next edge to explore from each vertex in the stack. */
+    rc = workspace_begin(g, ws, &tmp, &ws);
     if(rc != SUCCESS)
+    {
+        STATS_END();
         return rc;
+    }
+
+    vdeque_t *stack = &ws->stack;
+    edge_t **next_edge = ws->next_edge;
 
-    edge_t *e = v->edges;
-    while(e != NULL)
+    /* Create empty list of vertices, where the topologically-sorted
+     * vertices will be stored */
+    *l = calloc(1, sizeof(vlist_t));
+    if(*l == NULL)
+        rc = ENOMEM;
+    else
+        rc = vlist_init(*l);
+
+    /* Mark start vertex visited */
+    if(rc == SUCCESS)
+    {
+        graph_workspace_visit(ws, start);
+        next_edge[start] = g->vertices[start].edges;
+        STATS_VERTICES(1);
+        STATS_EDGES(g->vertices[start].degree);
+        rc = vdeque_push(stack, start);
+    }
+
+    while(rc == SUCCESS && stack->length > 0)
     {
+        unsigned int i;
+        vdeque_peek_head(stack, &i);
+
+        edge_t *e = next_edge[i];
+
+        /* Once every vertex reachable from i has been sorted,
+         * i goes at the head of the list */
+        if(e == NULL)
+        {
+            vdeque_pop(stack, NULL);
+            rc = vlist_insert_head(*l, &g->vertices[i]);
+            continue;
+        }
+
+        next_edge[i] = e->next;
+
         int i_next = graph_vertex_index(g, e->to);
-        if(i_next < 0)
-            return i_next;
+        assert(i_next >= 0);
 
-        if(!visited[i_next])
+        if(!graph_workspace_visited(ws, i_next))
         {
-            visited[i_next] = true;
-            rc = graph_toposort_visit(g, i_next, visited, l);
-            assert(rc == SUCCESS);
+            graph_workspace_visit(ws, i_next);
+            next_edge[i_next] = g->vertices[i_next].edges;
+            STATS_VERTICES(1);
+            STATS_EDGES(g->vertices[i_next].degree);
+            rc = vdeque_push(stack, i_next);
         }
+    }
+
+    workspace_end(ws, &tmp);
 
-        e = e->next;
+    if(rc != SUCCESS && *l != NULL)
+    {
+        vlist_free(*l);
+        free(*l);
+        *l = NULL;
     }
 
-    vlist_insert_head(l, v);
+    STATS_END();
 
-    return SUCCESS;
+    return rc;
 }
 
 
 /* See algorithms.h */
 int graph_toposort(graph_t *g, unsigned int start, vlist_t **l)
 {
-    /* Create boolean array to keep track of what vertices
-     * have been visited */
-    bool *visited = calloc(g->n_vertices, sizeof(bool));
+    return graph_toposort_ws(g, start, l, NULL);
+}
 
-    /* Create empty list of vertices, where the topologically-sorted
-     * vertices will be stored */
+
+/* See algorithms.h */
+int graph_dfs_iter_traverse(graph_t *g, unsigned int start, graph_traversal_t *t)
+{
     int rc;
-    *l = calloc(1, sizeof(vlist_t));
-    rc = vlist_init(*l);
-    if(rc != SUCCESS)
-        return rc;
+    graph_workspace_t tmp, *ws;
 
-    /* Mark start vertex visited */
-    visited[start] = true;
+    if(start >= g->n_vertices)
+        return EINDEX;
+
+    STATS_BEGIN();
 
-    /* Make first recursive call */
-    rc = graph_toposort_visit(g, start, visited, *l);
+    /* A vertex is visited when it is popped, but marked as visited when
+     * it is pushed, so we need to remember who pushed it */
+    rc = workspace_begin(g, t != NULL ? t->ws : NULL, &tmp, &ws);
     if(rc != SUCCESS)
+    {
+        STATS_END();
         return rc;
+    }
 
-    return SUCCESS;
+    vdeque_t *stack = &ws->stack;
+    unsigned int *parent = ws->parent, *depth = ws->depth;
+
+    traversal_begin(g->n_vertices, t);
+
+    vdeque_push(stack, start);
+    graph_workspace_visit(ws, start);
+    parent[start] = GRAPH_NO_VERTEX;
+    depth[start] = 0;
+
+    while(rc == SUCCESS && stack->length > 0)
+    {
+        unsigned int i;
+        vdeque_pop(stack, &i);
+
+        /* Process the vertex */
+        rc = traversal_visit(g, t, i, parent[i], depth[i]);
+
+        edge_t *e = g->vertices[i].edges;
+        STATS_EDGES(g->vertices[i].degree);
+        while(e != NULL && rc == SUCCESS)
+        {
+            int i_next = graph_vertex_index(g, e->to);
+            assert(i_next >= 0);
+
+            if(!graph_workspace_visited(ws, i_next))
+            {
+                graph_workspace_visit(ws, i_next);
+                parent[i_next] = i;
+                depth[i_next] = depth[i] + 1;
+                rc = vdeque_push(stack, i_next);
+            }
+
+            e = e->next;
+        }
+    }
+
+    workspace_end(ws, &tmp);
+
+    STATS_END();
+
+    return rc;
 }
 
 
 /* See algorithms.h */
 int graph_dfs_iter(graph_t *g, unsigned int start)
+{
+    graph_traversal_t t = { .visit = print_vertex };
+
+    return graph_dfs_iter_traverse(g, start, &t);
+}
+
+
+/*
+ * This is the DFS that builds the spanning tree, called by
+ * graph_spanning_tree_traverse. Like graph_dfs_visit, it uses a stack
+ * instead of recursion.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - start: The numerical index of the vertex to start with
+ *           (already marked as visited)
+ *  - ws: The workspace
+ *  - tree: The tree being built
+ *  - t: The traversal (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ *  - Otherwise, the value returned by the visitor function
+ *    that stopped the traversal
+ */
+static int graph_spanning_tree_visit(graph_t *g, unsigned int start, graph_workspace_t *ws,
+                                     graph_t *tree, graph_traversal_t *t)
 {
     int rc;
-    bool *visited;
-    vertex_t *v_start;
-    vlist_t stack;
+    vdeque_t *stack = &ws->stack;
 
-    visited = calloc(g->n_vertices, sizeof(bool));
-    if(visited == NULL)
+    ws->depth[start] = 0;
+    ws->next_edge[start] = g->vertices[start].edges;
+    STATS_EDGES(g->vertices[start].degree);
+    rc = vdeque_push(stack, start);
+
+    while(rc == SUCCESS && stack->length > 0)
+    {
+        unsigned int i;
+        vdeque_peek_head(stack, &i);
+
+        edge_t *e = ws->next_edge[i];
+
+        if(e == NULL)
+        {
+            vdeque_pop(stack, NULL);
+            continue;
+        }
+
+        ws->next_edge[i] = e->next;
+
+        int i_next = graph_vertex_index(g, e->to);
+        assert(i_next >= 0);
+
+        if(!graph_workspace_visited(ws, i_next))
+        {
+            graph_workspace_visit(ws, i_next);
+            ws->depth[i_next] = ws->depth[i] + 1;
+            ws->next_edge[i_next] = g->vertices[i_next].edges;
+            STATS_EDGES(g->vertices[i_next].degree);
+
+            rc = graph_add_edge(tree, i, i_next, e->weight);
+
+            if(rc == SUCCESS)
+                rc = traversal_visit(g, t, i_next, i, ws->depth[i_next]);
+
+            if(rc == SUCCESS)
+                rc = vdeque_push(stack, i_next);
+        }
+    }
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_spanning_tree_traverse(graph_t *g, unsigned int start, graph_t **tree,
+                                 graph_traversal_t *t)
+{
+    graph_workspace_t tmp, *ws;
+    int rc;
+
+    if(start >= g->n_vertices)
+        return EINDEX;
+
+    STATS_BEGIN();
+
+    *tree = calloc(1, sizeof(graph_t));
+    if(*tree == NULL)
+    {
+        STATS_END();
         return ENOMEM;
+    }
 
-    rc = vlist_init(&stack);
+    rc = graph_init(*tree, g->n_vertices);
     if(rc != SUCCESS)
+    {
+        free(*tree);
+        *tree = NULL;
+        STATS_END();
         return rc;
+    }
+
+    for(unsigned int i=0; i < g->n_vertices && rc == SUCCESS; i++)
+        rc = graph_set_label(*tree, i, g->vertices[i].label);
+
+    if(rc == SUCCESS)
+        rc = workspace_begin(g, t != NULL ? t->ws : NULL, &tmp, &ws);
 
-    rc = graph_get_vertex(g, start, &v_start);
     if(rc != SUCCESS)
+    {
+        graph_free(*tree);
+        free(*tree);
+        *tree = NULL;
+        STATS_END();
         return rc;
-    vlist_push(&stack, v_start);
+    }
+
+    traversal_begin(g->n_vertices, t);
+
+    /* Mark start vertex visited */
+    graph_workspace_visit(ws, start);
+
+    rc = traversal_visit(g, t, start, GRAPH_NO_VERTEX, 0);
+
+    if(rc == SUCCESS)
+        rc = graph_spanning_tree_visit(g, start, ws, *tree, t);
+
+    workspace_end(ws, &tmp);
+
+    if(rc != SUCCESS)
+    {
+        graph_free(*tree);
+        free(*tree);
+        *tree = NULL;
+    }
+
+    STATS_END();
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_spanning_tree(graph_t *g, unsigned int start, graph_t **tree)
+{
+    graph_traversal_t t = { .visit = print_tree_edge };
+
+    return graph_spanning_tree_traverse(g, start, tree, &t);
+}
+
+
+/* CSR FUNCTIONS */
+
+/* See algorithms.h */
+int graph_csr_bfs_traverse(graph_csr_t *csr, unsigned int start, graph_traversal_t *t)
+{
+    unsigned int n = csr->n_vertices;
+    unsigned int *queue;
+    bool *visited;
+    unsigned int head = 0, tail = 0, level_end, depth = 0;
+    int rc;
+
+    if(start >= n)
+        return EINDEX;
+
+    STATS_BEGIN();
+
+    /* Every vertex is enqueued at most once, so an array with
+     * room for all of them can be used as the queue */
+    visited = calloc(n, sizeof(bool));
+    queue = malloc(n * sizeof(unsigned int));
+    if(visited == NULL || queue == NULL)
+    {
+        free(visited);
+        free(queue);
+        STATS_END();
+        return ENOMEM;
+    }
+
+    STATS_ALLOC(2);
+
+    traversal_begin(n, t);
+
+    queue[tail++] = start;
     visited[start] = true;
+    level_end = tail;
 
-    while(stack.length > 0)
+    rc = traversal_visit(csr->source, t, start, GRAPH_NO_VERTEX, 0);
+
+    while(rc == SUCCESS && head < tail)
     {
-        vertex_t *v;
-        rc = vlist_pop(&stack, &v);
-        assert(rc == SUCCESS);
+        /* The queue holds one level after the other, so the next
+         * level starts where the current one ends */
+        if(head == level_end)
+        {
+            depth++;
+            level_end = tail;
+        }
 
-        /* Process the vertex (we just print it) */
-        int i = graph_vertex_index(g, v);
-        assert(i >= 0);
-        printf("%i: %s\n", i, v->label? v->label : "NO LABEL");
+        unsigned int i = queue[head++];
 
-        edge_t *e = v->edges;
-        while(e != NULL)
+        STATS_EDGES(csr->offsets[i + 1] - csr->offsets[i]);
+
+        for(unsigned long e = csr->offsets[i]; e < csr->offsets[i + 1] && rc == SUCCESS; e++)
         {
-            vertex_t *v_next = e->to;
-            int i_next = graph_vertex_index(g, v_next);
-            assert(i_next >= 0);
+            unsigned int i_next = csr->targets[e];
 
             if(!visited[i_next])
             {
                 visited[i_next] = true;
-                rc = vlist_push(&stack, v_next);
+                queue[tail++] = i_next;
+                rc = traversal_visit(csr->source, t, i_next, i, depth + 1);
             }
-
-            e = e->next;
         }
 
-        assert(rc == SUCCESS);
+        STATS_QUEUE(tail - head);
+    }
+
+    free(visited);
+    free(queue);
+
+    STATS_END();
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_csr_bfs(graph_csr_t *csr, unsigned int start)
+{
+    graph_traversal_t t = { .visit = print_csr_vertex, .arg = csr };
+
+    return graph_csr_bfs_traverse(csr, start, &t);
+}
+
+
+/*
+ * Stack used by the non-recursive depth-first traversals of a
+ * CSR snapshot. Each entry contains a vertex, and the position of
+ * the next edge of that vertex that has to be explored.
+ */
+typedef struct csr_stack {
+    unsigned int *v;
+    unsigned long *pos;
+    unsigned int length;
+} csr_stack_t;
+
+
+/*
+ * Helper function: allocates a stack with room for every vertex
+ * in a snapshot (a depth-first traversal can't push a vertex twice)
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - stack: The stack to initialize
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int csr_stack_init(graph_csr_t *csr, csr_stack_t *stack)
+{
+    stack->v = malloc(csr->n_vertices * sizeof(unsigned int));
+    stack->pos = malloc(csr->n_vertices * sizeof(unsigned long));
+    stack->length = 0;
+
+    if(stack->v == NULL || stack->pos == NULL)
+    {
+        free(stack->v);
+        free(stack->pos);
+        return ENOMEM;
     }
 
     return SUCCESS;
 }
 
 
+/* Helper function: pushes vertex i onto a CSR stack */
+static void csr_stack_push(graph_csr_t *csr, csr_stack_t *stack, unsigned int i)
+{
+    stack->v[stack->length] = i;
+    stack->pos[stack->length] = csr->offsets[i];
+    stack->length++;
+}
+
+
+/* Helper function: frees a CSR stack */
+static void csr_stack_free(csr_stack_t *stack)
+{
+    free(stack->v);
+    free(stack->pos);
+}
+
 
-static int graph_spanning_tree_visit(graph_t *g, unsigned int i, bool *visited, graph_t *tree)
+/*
+ * This is the equivalent of graph_dfs_visit for snapshots,
+ * called by graph_csr_dfs_traverse. Vertices are visited in the
+ * same order as graph_dfs_visit would visit them.
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - i: The numerical index of the vertex to start with
+ *  - visited: boolean array of visited vertices
+ *  - stack: An empty stack
+ *  - t: The traversal (can be NULL)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - Otherwise, the value returned by the visitor function
+ *    that stopped the traversal
+ */
+static int graph_csr_dfs_visit(graph_csr_t *csr, unsigned int i, bool *visited,
+                               csr_stack_t *stack, graph_traversal_t *t)
 {
     int rc;
-    vertex_t *v;
 
-    rc = graph_get_vertex(g, i, &v);
-    assert(rc == SUCCESS);
+    visited[i] = true;
+    rc = traversal_visit(csr->source, t, i, GRAPH_NO_VERTEX, 0);
+    if(rc != SUCCESS)
+        return rc;
 
-    edge_t *e = v->edges;
-    while(e != NULL)
+    csr_stack_push(csr, stack, i);
+
+    while(rc == SUCCESS && stack->length > 0)
     {
-        int i_next = graph_vertex_index(g, e->to);
-        if(i_next < 0)
-            return i_next;
+        unsigned int top = stack->length - 1;
+        unsigned int v = stack->v[top];
+
+        /* All the edges of this vertex have been explored */
+        if(stack->pos[top] == csr->offsets[v + 1])
+        {
+            stack->length--;
+            continue;
+        }
+
+        unsigned int i_next = csr->targets[stack->pos[top]++];
 
         if(!visited[i_next])
         {
             visited[i_next] = true;
-            printf("%i %i\n", i, i_next);
-            rc = graph_add_edge(tree, i, i_next, e->weight);
-            assert(rc == SUCCESS);
+            rc = traversal_visit(csr->source, t, i_next, v, stack->length);
+            if(rc == SUCCESS)
+                csr_stack_push(csr, stack, i_next);
+        }
+    }
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_csr_dfs_traverse(graph_csr_t *csr, unsigned int start, graph_traversal_t *t,
+                           unsigned int *n_components)
+{
+    bool *visited;
+    csr_stack_t stack;
+    int rc;
+
+    if(start >= csr->n_vertices)
+        return EINDEX;
+
+    visited = calloc(csr->n_vertices, sizeof(bool));
+    if(visited == NULL)
+        return ENOMEM;
 
-            rc = graph_spanning_tree_visit(g, i_next, visited, tree);
-            assert(rc == SUCCESS);
+    rc = csr_stack_init(csr, &stack);
+    if(rc != SUCCESS)
+    {
+        free(visited);
+        return rc;
+    }
+
+    traversal_begin(csr->n_vertices, t);
+
+    rc = graph_csr_dfs_visit(csr, start, visited, &stack, t);
+
+    unsigned int connected = 1;
+
+    for(unsigned int i=0; rc == SUCCESS && i < csr->n_vertices; i++)
+        if(!visited[i])
+        {
+            connected++;
+            rc = graph_csr_dfs_visit(csr, i, visited, &stack, t);
         }
 
-        e = e->next;
+    free(visited);
+    csr_stack_free(&stack);
+
+    if(rc == SUCCESS && n_components != NULL)
+        *n_components = connected;
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_csr_dfs(graph_csr_t *csr, unsigned int start)
+{
+    graph_traversal_t t = { .visit = print_csr_vertex, .arg = csr };
+    unsigned int connected;
+    int rc;
+
+    rc = graph_csr_dfs_traverse(csr, start, &t, &connected);
+    if(rc != SUCCESS)
+        return rc;
+
+    return connected;
+}
+
+
+/* See algorithms.h */
+int graph_csr_toposort(graph_csr_t *csr, unsigned int start,
+                       unsigned int *order, unsigned int *n_order)
+{
+    bool *visited;
+    csr_stack_t stack;
+    unsigned int n = 0;
+    int rc;
+
+    if(start >= csr->n_vertices)
+        return EINDEX;
+
+    visited = calloc(csr->n_vertices, sizeof(bool));
+    if(visited == NULL)
+        return ENOMEM;
+
+    rc = csr_stack_init(csr, &stack);
+    if(rc != SUCCESS)
+    {
+        free(visited);
+        return rc;
     }
 
+    /* Store the vertices in post-order, and then reverse them */
+    visited[start] = true;
+    csr_stack_push(csr, &stack, start);
+
+    while(stack.length > 0)
+    {
+        unsigned int top = stack.length - 1;
+        unsigned int v = stack.v[top];
+
+        if(stack.pos[top] == csr->offsets[v + 1])
+        {
+            order[n++] = v;
+            stack.length--;
+            continue;
+        }
+
+        unsigned int i_next = csr->targets[stack.pos[top]++];
+
+        if(!visited[i_next])
+        {
+            visited[i_next] = true;
+            csr_stack_push(csr, &stack, i_next);
+        }
+    }
+
+    for(unsigned int i = 0; i < n / 2; i++)
+    {
+        unsigned int tmp = order[i];
+        order[i] = order[n - 1 - i];
+        order[n - 1 - i] = tmp;
+    }
+    *n_order = n;
+
+    free(visited);
+    csr_stack_free(&stack);
+
     return SUCCESS;
 }
 
+
 /* See algorithms.h */
-int graph_spanning_tree(graph_t *g, unsigned int start, graph_t **tree)
+int graph_csr_spanning_tree_traverse(graph_csr_t *csr, unsigned int start, graph_t **tree,
+                                     graph_traversal_t *t)
 {
-    bool *visited = calloc(g->n_vertices, sizeof(bool));
+    bool *visited;
+    csr_stack_t stack;
     int rc;
 
+    if(start >= csr->n_vertices)
+        return EINDEX;
+
+    visited = calloc(csr->n_vertices, sizeof(bool));
+    if(visited == NULL)
+        return ENOMEM;
+
+    rc = csr_stack_init(csr, &stack);
+    if(rc != SUCCESS)
+    {
+        free(visited);
+        return rc;
+    }
+
     *tree = calloc(1, sizeof(graph_t));
-    rc = graph_init(*tree, g->n_vertices);
+    if(*tree == NULL)
+    {
+        rc = ENOMEM;
+        goto out;
+    }
 
-    for(unsigned int i=0; i < g->n_vertices; i++)
-        graph_set_label(*tree, i, g->vertices[i].label);
+    rc = graph_init(*tree, csr->n_vertices);
+    if(rc != SUCCESS)
+    {
+        free(*tree);
+        *tree = NULL;
+        goto out;
+    }
+
+    for(unsigned int i=0; i < csr->n_vertices; i++)
+    {
+        rc = graph_set_label(*tree, i, csr->labels[i]);
+        if(rc != SUCCESS)
+            goto out;
+    }
+
+    traversal_begin(csr->n_vertices, t);
 
     /* Mark start vertex visited */
     visited[start] = true;
+    csr_stack_push(csr, &stack, start);
 
-    rc = graph_spanning_tree_visit(g, start, visited, *tree);
-    assert(rc == SUCCESS);
+    rc = traversal_visit(csr->source, t, start, GRAPH_NO_VERTEX, 0);
 
-    return SUCCESS;
-}
\ No newline at end of file
+    while(rc == SUCCESS && stack.length > 0)
+    {
+        unsigned int top = stack.length - 1;
+        unsigned int v = stack.v[top];
+
+        if(stack.pos[top] == csr->offsets[v + 1])
+        {
+            stack.length--;
+            continue;
+        }
+
+        unsigned long e = stack.pos[top]++;
+        unsigned int i_next = csr->targets[e];
+
+        if(!visited[i_next])
+        {
+            visited[i_next] = true;
+            rc = graph_add_edge(*tree, v, i_next, csr->weights[e]);
+
+            if(rc == SUCCESS)
+                rc = traversal_visit(csr->source, t, i_next, v, stack.length);
+
+            if(rc == SUCCESS)
+                csr_stack_push(csr, &stack, i_next);
+        }
+    }
+
+out:
+    /* Don't leave a half-built tree behind */
+    if(rc != SUCCESS && *tree != NULL)
+    {
+        graph_free(*tree);
+        free(*tree);
+        *tree = NULL;
+    }
+
+    free(visited);
+    csr_stack_free(&stack);
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_csr_spanning_tree(graph_csr_t *csr, unsigned int start, graph_t **tree)
+{
+    graph_traversal_t t = { .visit = print_tree_edge };
+
+    return graph_csr_spanning_tree_traverse(csr, start, tree, &t);
+}
@@ -0,0 +1,426 @@
+#include "algorithms.h"
+#include "heap.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+
+/* FLOYD-WARSHALL
+ *
+ * The distance matrix is split into square tiles of APSP_TILE x APSP_TILE
+ * entries (the ones on the right and bottom edges may be smaller). For
+ * each block of APSP_TILE values of k, the tile on the diagonal is
+ * updated first, then the other tiles in its row and column (which only
+ * depend on themselves and the diagonal tile), and then all the others
+ * (which only depend on the tiles in their row and column). The tiles in
+ * each of the last two steps are independent, so they are split between
+ * the threads.
+ *
+ * Each tile update is a small Floyd-Warshall whose inner loop is a
+ * "min of sums" over a contiguous row, which compilers turn into SIMD
+ * instructions, and all three tiles it touches fit in the L1 cache.
+ */
+
+/* Number of rows and columns in a tile (a 64 x 64 tile of doubles
+ * takes 32 KiB) */
+#define APSP_TILE (64)
+
+
+/* State shared by the threads running Floyd-Warshall */
+typedef struct apsp_fw {
+    double *dist;
+    unsigned int n;
+
+    /* Number of tiles in each row and column */
+    unsigned int n_tiles;
+
+    pthread_barrier_t barrier;
+} apsp_fw_t;
+
+
+/*
+ * Helper function: updates a row of a tile with the paths through
+ * vertex k. This is the innermost loop of Floyd-Warshall. The pointers
+ * are restrict-qualified, so the compiler can vectorize it without
+ * checking whether the rows overlap.
+ *
+ * Parameters:
+ *  - c_i: The row being updated (row i)
+ *  - b_k: Row k, in the same columns
+ *  - a_ik: The distance from i to k
+ *  - n_j: Number of entries in the rows
+ */
+static void fw_row(double *restrict c_i, const double *restrict b_k, double a_ik, unsigned int n_j)
+{
+    for(unsigned int j = 0; j < n_j; j++)
+    {
+        double d = a_ik + b_k[j];
+        c_i[j] = d < c_i[j] ? d : c_i[j];
+    }
+}
+
+
+/*
+ * Helper function: updates tile c of the distance matrix with the paths
+ * through the vertices of a block of k values. a is the tile in the same
+ * rows as c and the columns of the block, and b the one in the rows of
+ * the block and the same columns as c (either of them can be c itself).
+ *
+ * Parameters:
+ *  - c, a, b: The first entry of each tile
+ *  - stride: Number of entries in a row of the matrix
+ *  - n_i, n_j: Number of rows and columns of c
+ *  - n_k: Number of values of k in the block
+ */
+static void fw_tile(double *c, const double *a, const double *b, unsigned long stride,
+                    unsigned int n_i, unsigned int n_j, unsigned int n_k)
+{
+    for(unsigned int k = 0; k < n_k; k++)
+    {
+        const double *b_k = b + k * stride;
+
+        for(unsigned int i = 0; i < n_i; i++)
+        {
+            double a_ik = a[i * stride + k];
+            double *c_i = c + i * stride;
+
+            /* If c_i is row k itself, a_ik is the distance from k to
+             * itself, which can only change row k if it is negative.
+             * Then there is a negative cycle through k, which is
+             * detected anyway when the distance from a vertex before
+             * k on the cycle to itself is updated. */
+            if(a_ik == INFINITY || c_i == b_k)
+                continue;
+
+            fw_row(c_i, b_k, a_ik, n_j);
+        }
+    }
+}
+
+
+/*
+ * Helper function: updates tile (ti, tj) of the distance matrix with
+ * the paths through the vertices of block kb
+ *
+ * Parameters:
+ *  - s: The Floyd-Warshall state
+ *  - ti, tj: The row and column of the tile
+ *  - kb: The block of k values
+ */
+static void fw_update(apsp_fw_t *s, unsigned int ti, unsigned int tj, unsigned int kb)
+{
+    unsigned long n = s->n;
+    unsigned int i0 = ti * APSP_TILE, j0 = tj * APSP_TILE, k0 = kb * APSP_TILE;
+    unsigned int n_i = n - i0 < APSP_TILE ? n - i0 : APSP_TILE;
+    unsigned int n_j = n - j0 < APSP_TILE ? n - j0 : APSP_TILE;
+    unsigned int n_k = n - k0 < APSP_TILE ? n - k0 : APSP_TILE;
+
+    fw_tile(s->dist + i0 * n + j0, s->dist + i0 * n + k0, s->dist + k0 * n + j0,
+            n, n_i, n_j, n_k);
+}
+
+
+/* Function run by each thread of Floyd-Warshall */
+static void fw_thread(unsigned int tid, unsigned int n_threads, void *arg)
+{
+    apsp_fw_t *s = arg;
+    unsigned int nt = s->n_tiles;
+
+    for(unsigned int kb = 0; kb < nt; kb++)
+    {
+        if(tid == 0)
+            fw_update(s, kb, kb, kb);
+
+        pthread_barrier_wait(&s->barrier);
+
+        /* The rest of row kb, and the rest of column kb */
+        for(unsigned int t = tid; t < 2 * nt; t += n_threads)
+        {
+            if(t % nt == kb)
+                continue;
+
+            if(t < nt)
+                fw_update(s, kb, t, kb);
+            else
+                fw_update(s, t - nt, kb, kb);
+        }
+
+        pthread_barrier_wait(&s->barrier);
+
+        /* Everything else, a row of tiles at a time */
+        for(unsigned int ti = tid; ti < nt; ti += n_threads)
+        {
+            if(ti == kb)
+                continue;
+
+            for(unsigned int tj = 0; tj < nt; tj++)
+                if(tj != kb)
+                    fw_update(s, ti, tj, kb);
+        }
+
+        pthread_barrier_wait(&s->barrier);
+    }
+}
+
+
+/*
+ * Helper function: computes all the shortest paths with Floyd-Warshall
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - n_threads: Number of threads to use
+ *  - dist: The distance matrix (see graph_all_shortest_paths)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ECYCLE: If the graph has a negative cycle
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int floyd_warshall(graph_t *g, unsigned int n_threads, double *dist)
+{
+    unsigned long n = g->n_vertices;
+    apsp_fw_t s;
+    int rc;
+
+    for(unsigned long i = 0; i < n * n; i++)
+        dist[i] = INFINITY;
+
+    for(unsigned long i = 0; i < n; i++)
+    {
+        dist[i * n + i] = 0.0;
+
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned long j = e->to - g->vertices;
+
+            if(e->weight < dist[i * n + j])
+                dist[i * n + j] = e->weight;
+        }
+    }
+
+    s.dist = dist;
+    s.n = n;
+    s.n_tiles = (n + APSP_TILE - 1) / APSP_TILE;
+
+    /* There are never more than n_tiles tiles to update at the same time */
+    if(n_threads > s.n_tiles)
+        n_threads = s.n_tiles > 0 ? s.n_tiles : 1;
+
+    pthread_barrier_init(&s.barrier, NULL, n_threads);
+    rc = parallel_run(n_threads, fw_thread, &s);
+    pthread_barrier_destroy(&s.barrier);
+
+    if(rc != SUCCESS)
+        return rc;
+
+    /* A vertex on a negative cycle ends up at a negative distance
+     * from itself */
+    for(unsigned long i = 0; i < n; i++)
+        if(dist[i * n + i] < 0)
+            return ECYCLE;
+
+    return SUCCESS;
+}
+
+
+/* JOHNSON'S ALGORITHM
+ *
+ * Each vertex v gets a potential h[v] (its distance from a virtual
+ * vertex with a zero-weight edge to every vertex, computed with
+ * Bellman-Ford), and the weight of each edge u->v is changed to
+ * w + h[u] - h[v]. This makes every weight non-negative without
+ * changing which paths are the shortest, so Dijkstra's algorithm can
+ * be run from every vertex. The runs are independent, so the sources
+ * are split between the threads.
+ */
+
+/* Number of sources a thread claims at a time */
+#define APSP_CHUNK (16)
+
+
+/* State shared by the threads running Johnson's algorithm */
+typedef struct apsp_johnson {
+    /* The graph, with the new weights */
+    graph_csr_t csr;
+
+    /* Potential of each vertex */
+    double *h;
+
+    double *dist;
+
+    /* Next source to claim */
+    atomic_uint cursor;
+
+    /* Set by the threads that run out of memory */
+    atomic_int rc;
+} apsp_johnson_t;
+
+
+/* Function run by each thread of Johnson's algorithm */
+static void johnson_thread(unsigned int tid, unsigned int n_threads, void *arg)
+{
+    apsp_johnson_t *s = arg;
+    graph_csr_t *csr = &s->csr;
+    unsigned long n = csr->n_vertices;
+    iheap_t heap;
+
+    (void) tid;
+    (void) n_threads;
+
+    if(iheap_init(&heap, n, IHEAP_DEFAULT_ARITY) != SUCCESS)
+    {
+        atomic_store(&s->rc, ENOMEM);
+        return;
+    }
+
+    while(true)
+    {
+        unsigned int first = atomic_fetch_add_explicit(&s->cursor, APSP_CHUNK, memory_order_relaxed);
+        if(first >= n)
+            break;
+
+        unsigned int last = first + APSP_CHUNK < n ? first + APSP_CHUNK : n;
+
+        for(unsigned int source = first; source < last; source++)
+        {
+            double *d = s->dist + source * n;
+
+            for(unsigned long i = 0; i < n; i++)
+                d[i] = INFINITY;
+
+            d[source] = 0.0;
+            iheap_push(&heap, source, 0.0);
+
+            while(heap.size > 0)
+            {
+                unsigned int i;
+                double d_i;
+
+                iheap_pop(&heap, &i, &d_i);
+
+                for(unsigned long k = csr->offsets[i]; k < csr->offsets[i + 1]; k++)
+                {
+                    unsigned int j = csr->targets[k];
+                    double d_j = d_i + csr->weights[k];
+
+                    if(d_j < d[j])
+                    {
+                        d[j] = d_j;
+                        iheap_push(&heap, j, d_j);
+                    }
+                }
+            }
+
+            /* Undo the change of weights */
+            for(unsigned long i = 0; i < n; i++)
+                if(d[i] != INFINITY)
+                    d[i] += s->h[i] - s->h[source];
+        }
+    }
+
+    iheap_free(&heap);
+}
+
+
+/*
+ * Helper function: computes all the shortest paths with Johnson's
+ * algorithm
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - n_threads: Number of threads to use
+ *  - dist: The distance matrix (see graph_all_shortest_paths)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ECYCLE: If the graph has a negative cycle
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int johnson(graph_t *g, unsigned int n_threads, double *dist)
+{
+    unsigned int n = g->n_vertices;
+    apsp_johnson_t s;
+    int rc;
+
+    rc = graph_freeze(g, &s.csr);
+    if(rc != SUCCESS)
+        return rc;
+
+    s.h = calloc(n > 0 ? n : 1, sizeof(double));
+    if(s.h == NULL)
+    {
+        graph_csr_free(&s.csr);
+        return ENOMEM;
+    }
+
+    /* Bellman-Ford from the virtual vertex. Its edges make every
+     * potential start at zero, and if the potentials still change
+     * after n rounds, there is a negative cycle. */
+    graph_csr_t *csr = &s.csr;
+    bool changed = true;
+
+    for(unsigned int round = 0; round <= n && changed; round++)
+    {
+        changed = false;
+
+        for(unsigned int i = 0; i < n; i++)
+            for(unsigned long k = csr->offsets[i]; k < csr->offsets[i + 1]; k++)
+                if(s.h[i] + csr->weights[k] < s.h[csr->targets[k]])
+                {
+                    s.h[csr->targets[k]] = s.h[i] + csr->weights[k];
+                    changed = true;
+                }
+    }
+
+    if(changed)
+    {
+        free(s.h);
+        graph_csr_free(&s.csr);
+        return ECYCLE;
+    }
+
+    /* The new weights are never negative (except for rounding error,
+     * which is removed) */
+    for(unsigned int i = 0; i < n; i++)
+        for(unsigned long k = csr->offsets[i]; k < csr->offsets[i + 1]; k++)
+        {
+            double w = csr->weights[k] + s.h[i] - s.h[csr->targets[k]];
+            csr->weights[k] = w > 0 ? w : 0.0;
+        }
+
+    s.dist = dist;
+    atomic_init(&s.cursor, 0);
+    atomic_init(&s.rc, SUCCESS);
+
+    rc = parallel_run(n_threads, johnson_thread, &s);
+    if(rc == SUCCESS)
+        rc = atomic_load(&s.rc);
+
+    free(s.h);
+    graph_csr_free(&s.csr);
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_all_shortest_paths(graph_t *g, int algorithm, unsigned int n_threads, double *dist)
+{
+    unsigned long n = g->n_vertices;
+
+    n_threads = parallel_threads(n_threads);
+
+    if(algorithm == GRAPH_APSP_AUTO)
+        algorithm = g->n_edges * GRAPH_APSP_DENSITY < n * n ?
+                    GRAPH_APSP_JOHNSON : GRAPH_APSP_FLOYD_WARSHALL;
+
+    if(algorithm == GRAPH_APSP_FLOYD_WARSHALL)
+        return floyd_warshall(g, n_threads, dist);
+
+    if(algorithm == GRAPH_APSP_JOHNSON)
+        return johnson(g, n_threads, dist);
+
+    return EINVAL;
+}
@@ -0,0 +1,654 @@
+#include "algorithms.h"
+#include "parallel.h"
+#include "counters.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+
+/* PARALLEL BFS
+ *
+ * graph_bfs_parallel is a level-synchronous BFS: all the vertices in
+ * the current frontier are expanded in parallel, and the vertices they
+ * discover form the next frontier. Threads claim chunks of the frontier
+ * with an atomic counter, claim vertices by atomically setting their bit
+ * in a shared visited bitmap, and collect the vertices they discover in
+ * a local buffer, which is appended to the next frontier when it fills up.
+ */
+
+/* Number of frontier vertices a thread claims at a time */
+#define PBFS_CHUNK (64)
+
+/* Number of vertices in each thread's local buffer */
+#define PBFS_BUFFER (1024)
+
+
+/* State shared by the threads running a parallel BFS */
+typedef struct pbfs {
+    graph_t *g;
+    unsigned int start;
+
+    /* Output arrays (parent can be NULL) */
+    unsigned int *depth;
+    unsigned int *parent;
+
+    /* One bit per vertex */
+    _Atomic uint64_t *visited;
+
+    /* Current and next frontier (each with room for every vertex) */
+    unsigned int *frontier;
+    unsigned int *next;
+    unsigned int frontier_len;
+    atomic_uint next_len;
+
+    /* Position of the next chunk of the frontier to expand */
+    atomic_uint cursor;
+
+    /* Depth of the vertices in the current frontier */
+    unsigned int level;
+
+    pthread_barrier_t barrier;
+} pbfs_t;
+
+
+/*
+ * Helper function: appends a thread's local buffer to the next frontier
+ *
+ * Parameters:
+ *  - s: The BFS state
+ *  - buf: The buffer
+ *  - n_buf: Number of vertices in the buffer (set to zero)
+ */
+static void pbfs_flush(pbfs_t *s, unsigned int *buf, unsigned int *n_buf)
+{
+    if(*n_buf == 0)
+        return;
+
+    unsigned int pos = atomic_fetch_add_explicit(&s->next_len, *n_buf, memory_order_relaxed);
+    memcpy(s->next + pos, buf, *n_buf * sizeof(unsigned int));
+    *n_buf = 0;
+}
+
+
+/* Function run by each thread of a parallel BFS */
+static void pbfs_thread(unsigned int tid, unsigned int n_threads, void *arg)
+{
+    pbfs_t *s = arg;
+    graph_t *g = s->g;
+    unsigned int buf[PBFS_BUFFER];
+    unsigned int n_buf = 0;
+    unsigned long begin, end;
+
+    /* Initialize the output arrays in parallel */
+    parallel_block(g->n_vertices, tid, n_threads, &begin, &end);
+    for(unsigned long i = begin; i < end; i++)
+    {
+        s->depth[i] = GRAPH_NO_VERTEX;
+        if(s->parent != NULL)
+            s->parent[i] = GRAPH_NO_VERTEX;
+    }
+
+    pthread_barrier_wait(&s->barrier);
+
+    if(tid == 0)
+    {
+        s->depth[s->start] = 0;
+        s->visited[s->start / 64] |= UINT64_C(1) << (s->start % 64);
+        s->frontier[0] = s->start;
+        s->frontier_len = 1;
+    }
+
+    pthread_barrier_wait(&s->barrier);
+
+    while(s->frontier_len > 0)
+    {
+        unsigned int next_depth = s->level + 1;
+
+        /* Expand chunks of the frontier until there are none left */
+        while(true)
+        {
+            unsigned int first = atomic_fetch_add_explicit(&s->cursor, PBFS_CHUNK, memory_order_relaxed);
+            if(first >= s->frontier_len)
+                break;
+
+            unsigned int last = first + PBFS_CHUNK;
+            if(last > s->frontier_len)
+                last = s->frontier_len;
+
+            for(unsigned int k = first; k < last; k++)
+            {
+                unsigned int i = s->frontier[k];
+
+                for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+                {
+                    unsigned int i_next = e->to - g->vertices;
+                    _Atomic uint64_t *word = &s->visited[i_next / 64];
+                    uint64_t bit = UINT64_C(1) << (i_next % 64);
+
+                    /* Check the bit before trying to set it, to avoid
+                     * contended atomic writes on already visited vertices */
+                    if(atomic_load_explicit(word, memory_order_relaxed) & bit)
+                        continue;
+                    if(atomic_fetch_or_explicit(word, bit, memory_order_relaxed) & bit)
+                        continue;
+
+                    /* This thread claimed the vertex */
+                    s->depth[i_next] = next_depth;
+                    if(s->parent != NULL)
+                        s->parent[i_next] = i;
+
+                    buf[n_buf++] = i_next;
+                    if(n_buf == PBFS_BUFFER)
+                        pbfs_flush(s, buf, &n_buf);
+                }
+            }
+        }
+
+        pbfs_flush(s, buf, &n_buf);
+
+        /* Once every thread is done, thread 0 moves on to the next level */
+        pthread_barrier_wait(&s->barrier);
+
+        if(tid == 0)
+        {
+            unsigned int *tmp = s->frontier;
+            s->frontier = s->next;
+            s->next = tmp;
+            s->frontier_len = atomic_load(&s->next_len);
+            atomic_store(&s->next_len, 0);
+            atomic_store(&s->cursor, 0);
+            s->level++;
+        }
+
+        pthread_barrier_wait(&s->barrier);
+    }
+}
+
+
+/* See algorithms.h */
+int graph_bfs_parallel(graph_t *g, unsigned int start, unsigned int n_threads,
+                       unsigned int *depth, unsigned int *parent)
+{
+    pbfs_t s;
+    int rc;
+
+    if(start >= g->n_vertices)
+        return EINDEX;
+
+    n_threads = parallel_threads(n_threads);
+
+    s.g = g;
+    s.start = start;
+    s.depth = depth;
+    s.parent = parent;
+    s.visited = calloc((g->n_vertices + 63) / 64, sizeof(uint64_t));
+    s.frontier = malloc(g->n_vertices * sizeof(unsigned int));
+    s.next = malloc(g->n_vertices * sizeof(unsigned int));
+    s.frontier_len = 0;
+    atomic_init(&s.next_len, 0);
+    atomic_init(&s.cursor, 0);
+    s.level = 0;
+
+    if(s.visited == NULL || s.frontier == NULL || s.next == NULL)
+    {
+        rc = ENOMEM;
+    }
+    else
+    {
+        pthread_barrier_init(&s.barrier, NULL, n_threads);
+        rc = parallel_run(n_threads, pbfs_thread, &s);
+        pthread_barrier_destroy(&s.barrier);
+    }
+
+    free((void *) s.visited);
+    free(s.frontier);
+    free(s.next);
+
+    return rc;
+}
+
+
+/* DIRECTION-OPTIMIZING BFS
+ *
+ * graph_csr_bfs_diropt implements the direction-optimizing BFS of
+ * Beamer, Asanovic and Patterson (SC '12). A top-down step looks at the
+ * out-edges of every vertex in the frontier. A bottom-up step instead
+ * looks at the in-edges of every unvisited vertex, and stops at the first
+ * one that comes from the frontier. When the frontier is a large fraction
+ * of the graph, most of the edges checked by a top-down step lead to
+ * vertices that have already been visited, and a bottom-up step is much
+ * cheaper.
+ *
+ * Top-down steps keep the frontier in a queue, and bottom-up steps keep
+ * it in a bitmap. The queue is a single array: the current frontier is
+ * queue[head..tail), and the next frontier is appended after it.
+ */
+
+/* Sets and tests bits in a bitmap of uint64_t words */
+#define BITMAP_WORDS(n) (((n) + 63) / 64)
+#define BITMAP_SET(b, i) ((b)[(i) / 64] |= UINT64_C(1) << ((i) % 64))
+#define BITMAP_TEST(b, i) (((b)[(i) / 64] >> ((i) % 64)) & 1)
+
+/* Out-degree of a vertex in a CSR snapshot */
+#define CSR_DEGREE(csr, i) ((csr)->offsets[(i) + 1] - (csr)->offsets[i])
+
+
+/* State of a direction-optimizing BFS */
+typedef struct diropt {
+    graph_csr_t *out;
+    graph_csr_t *in;
+    unsigned int *depth;
+    unsigned int *parent;
+
+    /* Frontier, as a queue and as a bitmap */
+    unsigned int *queue;
+    unsigned int head, tail;
+    uint64_t *front;
+    uint64_t *next;
+} diropt_t;
+
+
+/*
+ * Helper function: does one top-down step
+ *
+ * Parameters:
+ *  - s: The BFS state. The frontier is in queue[head..tail).
+ *  - level: Depth of the vertices in the frontier
+ *  - edges: Out parameter. The number of out-edges of the vertices
+ *           added to the next frontier.
+ *
+ * Returns:
+ *  - The number of vertices in the next frontier, which replaces
+ *    the current one in the queue
+ */
+static unsigned int diropt_top_down(diropt_t *s, unsigned int level, unsigned long *edges)
+{
+    graph_csr_t *out = s->out;
+    unsigned int end = s->tail;
+
+    *edges = 0;
+
+    for(unsigned int k = s->head; k < end; k++)
+    {
+        unsigned int i = s->queue[k];
+
+        for(unsigned long e = out->offsets[i]; e < out->offsets[i + 1]; e++)
+        {
+            unsigned int i_next = out->targets[e];
+
+            if(s->depth[i_next] != GRAPH_NO_VERTEX)
+                continue;
+
+            s->depth[i_next] = level + 1;
+            if(s->parent != NULL)
+                s->parent[i_next] = i;
+
+            s->queue[s->tail++] = i_next;
+            *edges += CSR_DEGREE(out, i_next);
+        }
+    }
+
+    s->head = end;
+
+    return s->tail - s->head;
+}
+
+
+/*
+ * Helper function: does one bottom-up step
+ *
+ * Parameters:
+ *  - s: The BFS state. The frontier is in the front bitmap.
+ *  - level: Depth of the vertices in the frontier
+ *  - edges: Out parameter. The number of out-edges of the vertices
+ *           added to the next frontier.
+ *
+ * Returns:
+ *  - The number of vertices in the next frontier, which replaces
+ *    the current one in the front bitmap
+ */
+static unsigned int diropt_bottom_up(diropt_t *s, unsigned int level, unsigned long *edges)
+{
+    graph_csr_t *in = s->in;
+    unsigned int n = in->n_vertices;
+    unsigned int count = 0;
+
+    *edges = 0;
+    memset(s->next, 0, BITMAP_WORDS(n) * sizeof(uint64_t));
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        if(s->depth[i] != GRAPH_NO_VERTEX)
+            continue;
+
+        for(unsigned long e = in->offsets[i]; e < in->offsets[i + 1]; e++)
+        {
+            unsigned int i_prev = in->targets[e];
+
+            if(!BITMAP_TEST(s->front, i_prev))
+                continue;
+
+            s->depth[i] = level + 1;
+            if(s->parent != NULL)
+                s->parent[i] = i_prev;
+
+            BITMAP_SET(s->next, i);
+            *edges += CSR_DEGREE(s->out, i);
+            count++;
+            break;
+        }
+    }
+
+    uint64_t *tmp = s->front;
+    s->front = s->next;
+    s->next = tmp;
+
+    return count;
+}
+
+
+/* See algorithms.h */
+int graph_csr_bfs_diropt(graph_csr_t *out, graph_csr_t *in, unsigned int start,
+                         unsigned int alpha, unsigned int beta,
+                         unsigned int *depth, unsigned int *parent)
+{
+    unsigned int n = out->n_vertices;
+    diropt_t s;
+    int rc;
+
+    if(start >= n)
+        return EINDEX;
+
+    if(alpha == 0)
+        alpha = GRAPH_BFS_ALPHA;
+    if(beta == 0)
+        beta = GRAPH_BFS_BETA;
+
+    s.out = out;
+    s.in = in;
+    s.depth = depth;
+    s.parent = parent;
+    s.queue = malloc(n * sizeof(unsigned int));
+    s.front = calloc(BITMAP_WORDS(n), sizeof(uint64_t));
+    s.next = calloc(BITMAP_WORDS(n), sizeof(uint64_t));
+
+    if(s.queue == NULL || s.front == NULL || s.next == NULL)
+    {
+        rc = ENOMEM;
+        goto done;
+    }
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        depth[i] = GRAPH_NO_VERTEX;
+        if(parent != NULL)
+            parent[i] = GRAPH_NO_VERTEX;
+    }
+
+    depth[start] = 0;
+    s.queue[0] = start;
+    s.head = 0;
+    s.tail = 1;
+
+    unsigned int level = 0;
+    unsigned int frontier = 1;
+    unsigned long frontier_edges = CSR_DEGREE(out, start);
+
+    /* Edges not yet checked by a top-down step */
+    unsigned long unexplored = out->n_edges - frontier_edges;
+
+    while(frontier > 0)
+    {
+        if(frontier_edges > unexplored / alpha)
+        {
+            /* Switch to bottom-up, and stay there while the frontier
+             * is growing or is still a large part of the graph */
+            for(unsigned int k = s.head; k < s.tail; k++)
+                BITMAP_SET(s.front, s.queue[k]);
+
+            unsigned int prev;
+            do
+            {
+                prev = frontier;
+                frontier = diropt_bottom_up(&s, level, &frontier_edges);
+                unexplored -= frontier_edges;
+                level++;
+            } while(frontier > 0 && (frontier >= prev || frontier > n / beta));
+
+            /* Switch back to top-down */
+            s.head = s.tail = 0;
+            for(unsigned int i = 0; i < n && frontier > 0; i++)
+                if(BITMAP_TEST(s.front, i))
+                    s.queue[s.tail++] = i;
+
+            memset(s.front, 0, BITMAP_WORDS(n) * sizeof(uint64_t));
+        }
+        else
+        {
+            frontier = diropt_top_down(&s, level, &frontier_edges);
+            unexplored -= frontier_edges;
+            level++;
+        }
+    }
+
+    rc = SUCCESS;
+
+done:
+    free(s.queue);
+    free(s.front);
+    free(s.next);
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_bfs_diropt(graph_t *g, unsigned int start, unsigned int alpha, unsigned int beta,
+                     unsigned int *depth, unsigned int *parent)
+{
+    graph_csr_t out, in;
+    int rc;
+
+    if(start >= g->n_vertices)
+        return EINDEX;
+
+    rc = graph_freeze(g, &out);
+    if(rc != SUCCESS)
+        return rc;
+
+    rc = graph_freeze_transpose(g, &in);
+    if(rc != SUCCESS)
+    {
+        graph_csr_free(&out);
+        return rc;
+    }
+
+    rc = graph_csr_bfs_diropt(&out, &in, start, alpha, beta, depth, parent);
+
+    graph_csr_free(&out);
+    graph_csr_free(&in);
+
+    return rc;
+}
+
+
+/* MULTI-SOURCE BFS
+ *
+ * graph_csr_msbfs runs BFSs from up to GRAPH_MSBFS_MAX_SOURCES sources at
+ * once, in the style of MS-BFS (Then et al.). Every vertex has a bitset
+ * with one bit per source, stored in consecutive 64-bit words: 'seen'
+ * has the sources that have reached the vertex, and 'visit' the ones
+ * that reached it in the last level. Expanding a vertex ORs its 'visit'
+ * bits into the 'next' bits of its neighbours, so one scan of its edges
+ * serves every BFS that has it in the frontier. Whatever a vertex gets
+ * in 'next' that it had not seen yet is the set of BFSs it joins at the
+ * next level.
+ *
+ * Only vertices in the frontier are expanded, and only vertices that
+ * got new bits are checked afterwards, so each level costs time
+ * proportional to the edges of the frontier rather than to the size of
+ * the graph.
+ */
+
+/* See algorithms.h */
+int graph_csr_msbfs(graph_csr_t *csr, const unsigned int *sources, unsigned int n_sources,
+                    unsigned int *dist)
+{
+    unsigned int n = csr->n_vertices;
+    unsigned int w = BITMAP_WORDS(n_sources);
+    int rc = SUCCESS;
+
+    if(n_sources == 0 || n_sources > GRAPH_MSBFS_MAX_SOURCES)
+        return EINVAL;
+
+    for(unsigned int s = 0; s < n_sources; s++)
+        if(sources[s] >= n)
+            return EINDEX;
+
+    STATS_BEGIN();
+
+    uint64_t *seen = calloc((size_t) n * w, sizeof(uint64_t));
+    uint64_t *visit = calloc((size_t) n * w, sizeof(uint64_t));
+    uint64_t *next = calloc((size_t) n * w, sizeof(uint64_t));
+
+    /* The vertices in the frontier, and the ones that
+     * got bits in 'next' while expanding it */
+    unsigned int *frontier = malloc(n * sizeof(unsigned int));
+    unsigned int *touched = malloc(n * sizeof(unsigned int));
+
+    if(seen == NULL || visit == NULL || next == NULL || frontier == NULL || touched == NULL)
+    {
+        rc = ENOMEM;
+        goto done;
+    }
+
+    STATS_ALLOC(5);
+
+    for(size_t k = 0; k < (size_t) n_sources * n; k++)
+        dist[k] = GRAPH_NO_VERTEX;
+
+    unsigned int n_frontier = 0;
+
+    for(unsigned int s = 0; s < n_sources; s++)
+    {
+        unsigned int i = sources[s];
+        bool first = true;
+
+        for(unsigned int k = 0; k < w; k++)
+            if(visit[(size_t) i * w + k] != 0)
+                first = false;
+
+        if(first)
+            frontier[n_frontier++] = i;
+
+        seen[(size_t) i * w + s / 64] |= 1ULL << (s % 64);
+        visit[(size_t) i * w + s / 64] |= 1ULL << (s % 64);
+        dist[(size_t) s * n + i] = 0;
+    }
+
+    for(unsigned int level = 1; n_frontier > 0; level++)
+    {
+        unsigned int n_touched = 0;
+
+        /* Expand the frontier */
+        for(unsigned int f = 0; f < n_frontier; f++)
+        {
+            unsigned int i = frontier[f];
+            const uint64_t *vi = &visit[(size_t) i * w];
+
+            STATS_VERTICES(1);
+            STATS_EDGES(CSR_DEGREE(csr, i));
+
+            for(unsigned long e = csr->offsets[i]; e < csr->offsets[i + 1]; e++)
+            {
+                unsigned int j = csr->targets[e];
+                const uint64_t *sj = &seen[(size_t) j * w];
+                uint64_t *nj = &next[(size_t) j * w];
+                uint64_t fresh = 0, had = 0;
+
+                /* Skip the edge if j has already seen all these sources */
+                for(unsigned int k = 0; k < w; k++)
+                    fresh |= vi[k] & ~sj[k];
+
+                if(fresh == 0)
+                    continue;
+
+                for(unsigned int k = 0; k < w; k++)
+                {
+                    had |= nj[k];
+                    nj[k] |= vi[k];
+                }
+
+                if(had == 0)
+                    touched[n_touched++] = j;
+            }
+        }
+
+        for(unsigned int f = 0; f < n_frontier; f++)
+            memset(&visit[(size_t) frontier[f] * w], 0, w * sizeof(uint64_t));
+
+        /* The vertices that got new bits form the next frontier */
+        n_frontier = 0;
+
+        for(unsigned int t = 0; t < n_touched; t++)
+        {
+            unsigned int j = touched[t];
+            uint64_t *sj = &seen[(size_t) j * w], *vj = &visit[(size_t) j * w];
+            uint64_t *nj = &next[(size_t) j * w];
+            bool any = false;
+
+            for(unsigned int k = 0; k < w; k++)
+            {
+                uint64_t fresh = nj[k] & ~sj[k];
+
+                nj[k] = 0;
+                sj[k] |= fresh;
+                vj[k] = fresh;
+
+                for(; fresh != 0; fresh &= fresh - 1)
+                {
+                    unsigned int s = k * 64 + __builtin_ctzll(fresh);
+                    dist[(size_t) s * n + j] = level;
+                    any = true;
+                }
+            }
+
+            if(any)
+                frontier[n_frontier++] = j;
+        }
+
+        STATS_QUEUE(n_frontier);
+    }
+
+done:
+    free(seen);
+    free(visit);
+    free(next);
+    free(frontier);
+    free(touched);
+
+    STATS_END();
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_msbfs(graph_t *g, const unsigned int *sources, unsigned int n_sources,
+                unsigned int *dist)
+{
+    graph_csr_t csr;
+    int rc;
+
+    rc = graph_freeze(g, &csr);
+    if(rc != SUCCESS)
+        return rc;
+
+    rc = graph_csr_msbfs(&csr, sources, n_sources, dist);
+
+    graph_csr_free(&csr);
+
+    return rc;
+}
@@ -0,0 +1,526 @@
+#include "algorithms.h"
+#include "dset.h"
+#include "parallel.h"
+#include "counters.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+
+/* See algorithms.h */
+int graph_connected_components(graph_t *g, unsigned int *comp, unsigned int *n_comp)
+{
+    unsigned int n = g->n_vertices;
+    dset_t d;
+    int rc;
+
+    STATS_BEGIN();
+
+    rc = dset_init(&d, n);
+    if(rc != SUCCESS)
+    {
+        STATS_END();
+        return rc;
+    }
+
+    STATS_ALLOC(2);
+
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+            dset_union(&d, i, e->to - g->vertices);
+
+    STATS_VERTICES(n);
+    STATS_EDGES(g->n_edges);
+
+    /* Number the components in order of their lowest vertex. The entry
+     * of each root holds the number of its component as soon as the
+     * first vertex of the component is reached, so comp doubles as the
+     * map from roots to component numbers. */
+    unsigned int count = 0;
+
+    for(unsigned int i = 0; i < n; i++)
+        comp[i] = GRAPH_NO_VERTEX;
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        if(g->vertices[i].removed)
+            continue;
+
+        unsigned int r = dset_find(&d, i);
+
+        if(comp[r] == GRAPH_NO_VERTEX)
+            comp[r] = count++;
+
+        comp[i] = comp[r];
+    }
+
+    *n_comp = count;
+
+    dset_free(&d);
+
+    STATS_END();
+
+    return SUCCESS;
+}
+
+
+/* PARALLEL CONNECTED COMPONENTS
+ *
+ * graph_connected_components_parallel is a lock-free union-find in the
+ * style of Shiloach-Vishkin and Afforest. Every vertex has a parent,
+ * which is never greater than the vertex itself, so the root of each
+ * tree is its lowest vertex. Two trees are linked by pointing the higher
+ * root at the lower one with a compare-and-swap, which fails (and is
+ * retried) if some other thread has just linked that root elsewhere.
+ * Since parents only ever decrease, the trees stay acyclic without locks.
+ *
+ * Like Afforest, the edges are processed in two rounds. The first round
+ * only links each vertex with its first few neighbours, and is followed
+ * by a compression pass that points every vertex directly at its root.
+ * This usually merges most of the graph into a few large, flat trees, so
+ * in the second round most of the remaining edges are found to connect
+ * vertices that already have the same root after one or two loads, and
+ * are skipped without any atomic writes.
+ */
+
+/* Number of edges of each vertex that are processed in the first round */
+#define CC_SAMPLE (2)
+
+
+/* State shared by the threads labelling components */
+typedef struct cc {
+    graph_t *g;
+    atomic_uint *parent;
+
+    pthread_barrier_t barrier;
+} cc_t;
+
+
+/*
+ * Helper function: finds the root of a vertex's tree, halving the path
+ * to it on the way. Other threads can change the parents concurrently,
+ * but they only ever move them closer to the root.
+ *
+ * Parameters:
+ *  - parent: The parents of the vertices
+ *  - x: The vertex
+ *
+ * Returns:
+ *  - The root of the tree (which may no longer be a root by the time
+ *    the function returns)
+ */
+static unsigned int cc_find(atomic_uint *parent, unsigned int x)
+{
+    while(true)
+    {
+        unsigned int p = atomic_load_explicit(&parent[x], memory_order_relaxed);
+        if(p == x)
+            return x;
+
+        unsigned int gp = atomic_load_explicit(&parent[p], memory_order_relaxed);
+        if(gp == p)
+            return p;
+
+        /* gp < p, so this can only move x closer to its root. If another
+         * thread changed parent[x] in the meantime, it pointed it at least
+         * as close to the root, and this store may undo part of that,
+         * which costs time but keeps the tree correct. */
+        atomic_store_explicit(&parent[x], gp, memory_order_relaxed);
+        x = gp;
+    }
+}
+
+
+/*
+ * Helper function: merges the trees of two vertices
+ *
+ * Parameters:
+ *  - parent: The parents of the vertices
+ *  - x, y: The vertices
+ */
+static void cc_link(atomic_uint *parent, unsigned int x, unsigned int y)
+{
+    unsigned int rx = cc_find(parent, x);
+    unsigned int ry = cc_find(parent, y);
+
+    while(rx != ry)
+    {
+        unsigned int high = rx > ry ? rx : ry;
+        unsigned int low = rx > ry ? ry : rx;
+        unsigned int expected = high;
+
+        if(atomic_compare_exchange_strong_explicit(&parent[high], &expected, low,
+                                                   memory_order_relaxed, memory_order_relaxed))
+            return;
+
+        /* Someone else linked 'high' first. Start over from the new roots. */
+        rx = cc_find(parent, high);
+        ry = cc_find(parent, low);
+    }
+}
+
+
+/*
+ * Helper function: points every vertex in a block directly at its root
+ *
+ * Parameters:
+ *  - parent: The parents of the vertices
+ *  - begin, end: The block of vertices
+ */
+static void cc_compress(atomic_uint *parent, unsigned long begin, unsigned long end)
+{
+    for(unsigned long i = begin; i < end; i++)
+        atomic_store_explicit(&parent[i], cc_find(parent, i), memory_order_relaxed);
+}
+
+
+/* Function run by each thread labelling components */
+static void cc_thread(unsigned int tid, unsigned int n_threads, void *arg)
+{
+    cc_t *s = arg;
+    graph_t *g = s->g;
+    unsigned long begin, end;
+
+    parallel_block(g->n_vertices, tid, n_threads, &begin, &end);
+
+    /* First round: link each vertex with its first few neighbours */
+    for(unsigned long i = begin; i < end; i++)
+    {
+        edge_t *e = g->vertices[i].edges;
+        for(unsigned int k = 0; e != NULL && k < CC_SAMPLE; e = e->next, k++)
+            cc_link(s->parent, i, e->to - g->vertices);
+    }
+
+    pthread_barrier_wait(&s->barrier);
+    cc_compress(s->parent, begin, end);
+    pthread_barrier_wait(&s->barrier);
+
+    /* Second round: the rest of the edges */
+    for(unsigned long i = begin; i < end; i++)
+    {
+        edge_t *e = g->vertices[i].edges;
+        for(unsigned int k = 0; e != NULL && k < CC_SAMPLE; e = e->next, k++)
+            ;
+
+        for(; e != NULL; e = e->next)
+            cc_link(s->parent, i, e->to - g->vertices);
+    }
+}
+
+
+/* See algorithms.h */
+int graph_connected_components_parallel(graph_t *g, unsigned int n_threads,
+                                        unsigned int *comp, unsigned int *n_comp)
+{
+    unsigned int n = g->n_vertices;
+    cc_t s;
+    int rc;
+
+    n_threads = parallel_threads(n_threads);
+
+    s.g = g;
+    s.parent = malloc((n > 0 ? n : 1) * sizeof(atomic_uint));
+
+    if(s.parent == NULL)
+        return ENOMEM;
+
+    for(unsigned int i = 0; i < n; i++)
+        atomic_init(&s.parent[i], i);
+
+    pthread_barrier_init(&s.barrier, NULL, n_threads);
+    rc = parallel_run(n_threads, cc_thread, &s);
+    pthread_barrier_destroy(&s.barrier);
+
+    if(rc != SUCCESS)
+    {
+        free(s.parent);
+        return rc;
+    }
+
+    /* The roots are now the lowest vertices of their components, and
+     * every other vertex points at a lower vertex of its component,
+     * so the components can be numbered in order of their lowest
+     * vertex in a single pass */
+    unsigned int count = 0;
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        unsigned int r = atomic_load_explicit(&s.parent[i], memory_order_relaxed);
+
+        if(g->vertices[i].removed)
+            comp[i] = GRAPH_NO_VERTEX;
+        else if(r == i)
+            comp[i] = count++;
+        else
+            comp[i] = comp[r];
+    }
+
+    *n_comp = count;
+
+    free(s.parent);
+
+    return SUCCESS;
+}
+
+
+/* STRONGLY CONNECTED COMPONENTS
+ *
+ * graph_scc is Tarjan's algorithm, with the recursion replaced by an
+ * explicit call stack. Each entry of the call stack holds a vertex and
+ * the next of its edges to follow, which is exactly the state that the
+ * recursive version keeps in its stack frames.
+ */
+
+/*
+ * Helper function: builds the condensation of a graph, given its
+ * strongly connected components
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - comp: The component of each vertex (GRAPH_NO_VERTEX for
+ *          removed vertices)
+ *  - n_comp: The number of components
+ *  - cond: Out parameter for the condensation (see graph_scc)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int scc_condense(graph_t *g, unsigned int *comp, unsigned int n_comp, graph_t **cond)
+{
+    unsigned int n = g->n_vertices;
+    int rc;
+
+    *cond = calloc(1, sizeof(graph_t));
+    if(*cond == NULL)
+        return ENOMEM;
+
+    rc = graph_init(*cond, n_comp);
+    if(rc != SUCCESS)
+    {
+        free(*cond);
+        *cond = NULL;
+        return rc;
+    }
+
+    /* Group the vertices by component (members[start[c]..start[c+1])
+     * are the vertices of component c, in increasing order) */
+    unsigned int *start = calloc(n_comp + 1, sizeof(unsigned int));
+    unsigned int *members = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+
+    /* Edges out of the current component: mark[c] is the current
+     * component if there is an edge to c, and slot[c] is its position
+     * in targets and weights */
+    unsigned int *mark = malloc((n_comp > 0 ? n_comp : 1) * sizeof(unsigned int));
+    unsigned int *slot = malloc((n_comp > 0 ? n_comp : 1) * sizeof(unsigned int));
+    unsigned int *targets = malloc((n_comp > 0 ? n_comp : 1) * sizeof(unsigned int));
+    double *weights = malloc((n_comp > 0 ? n_comp : 1) * sizeof(double));
+
+    if(start == NULL || members == NULL || mark == NULL ||
+       slot == NULL || targets == NULL || weights == NULL)
+        rc = ENOMEM;
+
+    if(rc == SUCCESS)
+    {
+        for(unsigned int i = 0; i < n; i++)
+            if(comp[i] != GRAPH_NO_VERTEX)
+                start[comp[i] + 1]++;
+
+        for(unsigned int c = 0; c < n_comp; c++)
+        {
+            start[c + 1] += start[c];
+            mark[c] = GRAPH_NO_VERTEX;
+        }
+
+        /* slot is used as the insertion point of each component here */
+        for(unsigned int c = 0; c < n_comp; c++)
+            slot[c] = start[c];
+
+        for(unsigned int i = 0; i < n; i++)
+            if(comp[i] != GRAPH_NO_VERTEX)
+                members[slot[comp[i]]++] = i;
+    }
+
+    for(unsigned int c = 0; c < n_comp && rc == SUCCESS; c++)
+    {
+        unsigned int n_targets = 0;
+
+        /* Each component is named after its lowest vertex */
+        rc = graph_set_label(*cond, c, g->vertices[members[start[c]]].label);
+
+        for(unsigned int k = start[c]; k < start[c + 1]; k++)
+            for(edge_t *e = g->vertices[members[k]].edges; e != NULL; e = e->next)
+            {
+                unsigned int c_next = comp[e->to - g->vertices];
+
+                if(c_next == c)
+                    continue;
+
+                if(mark[c_next] != c)
+                {
+                    mark[c_next] = c;
+                    slot[c_next] = n_targets;
+                    targets[n_targets] = c_next;
+                    weights[n_targets] = e->weight;
+                    n_targets++;
+                }
+                else if(e->weight < weights[slot[c_next]])
+                {
+                    weights[slot[c_next]] = e->weight;
+                }
+            }
+
+        /* graph_add_edge prepends, so add the edges backwards to keep
+         * them in the order they were found */
+        while(n_targets > 0 && rc == SUCCESS)
+        {
+            n_targets--;
+            rc = graph_add_edge(*cond, c, targets[n_targets], weights[n_targets]);
+        }
+    }
+
+    free(start);
+    free(members);
+    free(mark);
+    free(slot);
+    free(targets);
+    free(weights);
+
+    if(rc != SUCCESS)
+    {
+        graph_free(*cond);
+        free(*cond);
+        *cond = NULL;
+    }
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_scc(graph_t *g, unsigned int *comp, unsigned int *n_comp, graph_t **cond)
+{
+    unsigned int n = g->n_vertices;
+    int rc = SUCCESS;
+
+    if(cond != NULL)
+        *cond = NULL;
+
+    STATS_BEGIN();
+
+    /* index[i] is the order in which vertex i was visited, and low[i] the
+     * lowest index reachable from the subtree of i through vertices that
+     * are still on the stack. A vertex is on the stack if it has been
+     * visited but not assigned to a component. */
+    unsigned int *index = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    unsigned int *low = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    unsigned int *stack = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    unsigned int *call_v = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    edge_t **call_e = malloc((n > 0 ? n : 1) * sizeof(edge_t*));
+
+    if(index == NULL || low == NULL || stack == NULL || call_v == NULL || call_e == NULL)
+    {
+        free(index);
+        free(low);
+        free(stack);
+        free(call_v);
+        free(call_e);
+        STATS_END();
+        return ENOMEM;
+    }
+
+    STATS_ALLOC(5);
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        index[i] = GRAPH_NO_VERTEX;
+        comp[i] = GRAPH_NO_VERTEX;
+    }
+
+    unsigned int n_visited = 0, n_stack = 0, n_call = 0, count = 0;
+
+    for(unsigned int s = 0; s < n; s++)
+    {
+        if(index[s] != GRAPH_NO_VERTEX || g->vertices[s].removed)
+            continue;
+
+        index[s] = low[s] = n_visited++;
+        stack[n_stack++] = s;
+        call_v[n_call] = s;
+        call_e[n_call] = g->vertices[s].edges;
+        n_call++;
+
+        while(n_call > 0)
+        {
+            unsigned int i = call_v[n_call - 1];
+            edge_t *e = call_e[n_call - 1];
+
+            if(e != NULL)
+            {
+                call_e[n_call - 1] = e->next;
+
+                unsigned int i_next = e->to - g->vertices;
+
+                if(index[i_next] == GRAPH_NO_VERTEX)
+                {
+                    /* "Recursive call" on i_next */
+                    index[i_next] = low[i_next] = n_visited++;
+                    stack[n_stack++] = i_next;
+                    STATS_QUEUE(n_stack);
+                    call_v[n_call] = i_next;
+                    call_e[n_call] = g->vertices[i_next].edges;
+                    n_call++;
+                }
+                else if(comp[i_next] == GRAPH_NO_VERTEX && index[i_next] < low[i])
+                {
+                    low[i] = index[i_next];
+                }
+
+                continue;
+            }
+
+            /* All the edges of i have been followed. If i is the root of
+             * a component, the component is at the top of the stack. */
+            n_call--;
+
+            if(low[i] == index[i])
+            {
+                unsigned int j;
+                do
+                {
+                    j = stack[--n_stack];
+                    comp[j] = count;
+                } while(j != i);
+
+                count++;
+            }
+
+            if(n_call > 0 && low[i] < low[call_v[n_call - 1]])
+                low[call_v[n_call - 1]] = low[i];
+        }
+    }
+
+    free(index);
+    free(low);
+    free(stack);
+    free(call_v);
+    free(call_e);
+
+    STATS_VERTICES(n_visited);
+    STATS_EDGES(g->n_edges);
+
+    /* Tarjan's algorithm finds a component only after all the components
+     * it has edges to, so reversing the numbering sorts them topologically */
+    for(unsigned int i = 0; i < n; i++)
+        if(comp[i] != GRAPH_NO_VERTEX)
+            comp[i] = count - 1 - comp[i];
+
+    *n_comp = count;
+
+    if(cond != NULL)
+        rc = scc_condense(g, comp, count, cond);
+
+    STATS_END();
+
+    return rc;
+}
@@ -0,0 +1,56 @@
+/*
+ * Counters for the per-call statistics (see stats.h)
+ *
+ * This is an internal header. Instrumented functions wrap their work
+ * between STATS_BEGIN and STATS_END, and count it with the other macros.
+ * Calls can be nested: only the outermost one is recorded. Without
+ * GRAPH_ENABLE_STATS, all the macros expand to nothing.
+ *
+ */
+
+#ifndef SRC_LIBGRAPH_COUNTERS_H_
+#define SRC_LIBGRAPH_COUNTERS_H_
+
+#include "stats.h"
+
+#ifdef GRAPH_ENABLE_STATS
+
+/* Counters of the call in progress on this thread */
+extern _Thread_local graph_stats_t stats_current;
+
+/*
+ * Starts counting a call (unless it is nested in another one)
+ *
+ * Parameters:
+ *  - function: The name of the instrumented function
+ */
+void stats_begin(const char *function);
+
+/*
+ * Finishes counting a call, and records its statistics as
+ * the last call of this thread (unless it is nested)
+ */
+void stats_end(void);
+
+#define STATS_BEGIN()       stats_begin(__func__)
+#define STATS_END()         stats_end()
+#define STATS_VERTICES(n)   (stats_current.vertices_visited += (n))
+#define STATS_EDGES(n)      (stats_current.edges_scanned += (n))
+#define STATS_ALLOC(n)      (stats_current.allocations += (n))
+#define STATS_QUEUE(len)    do {                                              \
+                                if((len) > stats_current.queue_max)           \
+                                    stats_current.queue_max = (len);          \
+                            } while(0)
+
+#else
+
+#define STATS_BEGIN()       ((void) 0)
+#define STATS_END()         ((void) 0)
+#define STATS_VERTICES(n)   ((void) 0)
+#define STATS_EDGES(n)      ((void) 0)
+#define STATS_ALLOC(n)      ((void) 0)
+#define STATS_QUEUE(len)    ((void) 0)
+
+#endif
+
+#endif
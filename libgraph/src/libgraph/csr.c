@@ -0,0 +1,178 @@
+#include "csr.h"
+#include <stdlib.h>
+#include <sys/mman.h>
+
+
+/* See csr.h */
+int graph_freeze(graph_t *g, graph_csr_t *csr)
+{
+    unsigned int n = g->n_vertices;
+    unsigned long n_edges = 0;
+
+    /* Count the edges, so we can allocate the arrays in one go */
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+            n_edges++;
+
+    csr->n_vertices = n;
+    csr->n_edges = n_edges;
+    csr->map = NULL;
+    csr->map_len = 0;
+    csr->offsets = malloc((n + 1) * sizeof(unsigned long));
+    csr->targets = malloc((n_edges > 0 ? n_edges : 1) * sizeof(unsigned int));
+    csr->weights = malloc((n_edges > 0 ? n_edges : 1) * sizeof(double));
+    csr->labels = malloc(n * sizeof(char*));
+
+    if(csr->offsets == NULL || csr->targets == NULL ||
+       csr->weights == NULL || csr->labels == NULL)
+    {
+        graph_csr_free(csr);
+        return ENOMEM;
+    }
+
+    unsigned long pos = 0;
+    for(unsigned int i = 0; i < n; i++)
+    {
+        csr->offsets[i] = pos;
+        csr->labels[i] = g->vertices[i].label;
+
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            csr->targets[pos] = e->to - g->vertices;
+            csr->weights[pos] = e->weight;
+            pos++;
+        }
+    }
+    csr->offsets[n] = pos;
+
+    csr->source = g;
+    csr->version = g->version;
+    csr->transposed = false;
+
+    return SUCCESS;
+}
+
+
+/* See csr.h */
+int graph_freeze_transpose(graph_t *g, graph_csr_t *csr)
+{
+    unsigned int n = g->n_vertices;
+    unsigned long n_edges = 0;
+
+    csr->n_vertices = n;
+    csr->map = NULL;
+    csr->map_len = 0;
+    csr->offsets = calloc(n + 1, sizeof(unsigned long));
+    csr->targets = NULL;
+    csr->weights = NULL;
+    csr->labels = malloc(n * sizeof(char*));
+
+    if(csr->offsets == NULL || csr->labels == NULL)
+    {
+        graph_csr_free(csr);
+        return ENOMEM;
+    }
+
+    /* Count the edges leading to each vertex. The count for vertex i
+     * is stored in offsets[i+1], so that adding up the counts turns
+     * offsets[i] into the position of the first edge of vertex i. */
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            csr->offsets[e->to - g->vertices + 1]++;
+            n_edges++;
+        }
+
+    for(unsigned int i = 0; i < n; i++)
+        csr->offsets[i + 1] += csr->offsets[i];
+
+    csr->n_edges = n_edges;
+    csr->targets = malloc((n_edges > 0 ? n_edges : 1) * sizeof(unsigned int));
+    csr->weights = malloc((n_edges > 0 ? n_edges : 1) * sizeof(double));
+    unsigned long *next = malloc(n * sizeof(unsigned long));
+
+    if(csr->targets == NULL || csr->weights == NULL || next == NULL)
+    {
+        free(next);
+        graph_csr_free(csr);
+        return ENOMEM;
+    }
+
+    /* next[i] is where the next edge leading to vertex i goes. Since the
+     * sources are visited in order, each vertex's edges end up sorted. */
+    for(unsigned int i = 0; i < n; i++)
+    {
+        next[i] = csr->offsets[i];
+        csr->labels[i] = g->vertices[i].label;
+    }
+
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned long pos = next[e->to - g->vertices]++;
+            csr->targets[pos] = i;
+            csr->weights[pos] = e->weight;
+        }
+
+    free(next);
+
+    csr->source = g;
+    csr->version = g->version;
+    csr->transposed = true;
+
+    return SUCCESS;
+}
+
+
+/* See csr.h */
+bool graph_csr_is_stale(graph_t *g, graph_csr_t *csr)
+{
+    return csr->source != g || csr->version != g->version;
+}
+
+
+/* See csr.h */
+int graph_csr_refresh(graph_t *g, graph_csr_t *csr)
+{
+    if(!graph_csr_is_stale(g, csr))
+        return SUCCESS;
+
+    bool transposed = csr->transposed;
+
+    graph_csr_free(csr);
+
+    if(transposed)
+        return graph_freeze_transpose(g, csr);
+
+    return graph_freeze(g, csr);
+}
+
+
+/* See csr.h */
+int graph_csr_free(graph_csr_t *csr)
+{
+    if(csr->map != NULL)
+    {
+        munmap(csr->map, csr->map_len);
+    }
+    else
+    {
+        free(csr->offsets);
+        free(csr->targets);
+        free(csr->weights);
+    }
+    free(csr->labels);
+
+    csr->offsets = NULL;
+    csr->targets = NULL;
+    csr->weights = NULL;
+    csr->labels = NULL;
+    csr->n_vertices = 0;
+    csr->n_edges = 0;
+    csr->source = NULL;
+    csr->transposed = false;
+    csr->map = NULL;
+    csr->map_len = 0;
+
+    return SUCCESS;
+}
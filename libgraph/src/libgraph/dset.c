@@ -0,0 +1,84 @@
+#include "dset.h"
+#include <stdlib.h>
+
+
+/* See dset.h */
+int dset_init(dset_t *d, unsigned int n)
+{
+    d->n = n;
+    d->n_sets = n;
+    d->parent = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    d->size = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+
+    if(d->parent == NULL || d->size == NULL)
+    {
+        free(d->parent);
+        free(d->size);
+        return ENOMEM;
+    }
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        d->parent[i] = i;
+        d->size[i] = 1;
+    }
+
+    return SUCCESS;
+}
+
+
+/* See dset.h */
+int dset_free(dset_t *d)
+{
+    free(d->parent);
+    free(d->size);
+
+    return SUCCESS;
+}
+
+
+/* See dset.h */
+unsigned int dset_find(dset_t *d, unsigned int x)
+{
+    /* Path halving: make every other element on the
+     * path point to its grandparent */
+    while(d->parent[x] != x)
+    {
+        d->parent[x] = d->parent[d->parent[x]];
+        x = d->parent[x];
+    }
+
+    return x;
+}
+
+
+/* See dset.h */
+bool dset_union(dset_t *d, unsigned int x, unsigned int y)
+{
+    x = dset_find(d, x);
+    y = dset_find(d, y);
+
+    if(x == y)
+        return false;
+
+    /* The smaller set goes under the root of the larger one */
+    if(d->size[x] < d->size[y])
+    {
+        unsigned int tmp = x;
+        x = y;
+        y = tmp;
+    }
+
+    d->parent[y] = x;
+    d->size[x] += d->size[y];
+    d->n_sets--;
+
+    return true;
+}
+
+
+/* See dset.h */
+bool dset_same(dset_t *d, unsigned int x, unsigned int y)
+{
+    return dset_find(d, x) == dset_find(d, y);
+}
@@ -0,0 +1,561 @@
+#include "flow.h"
+#include <stdlib.h>
+
+
+/* Marks vertices that have no level/height yet */
+#define FLOW_NONE (~0u)
+
+
+/* A residual graph. The arcs of vertex i are arcs offsets[i] through
+ * offsets[i+1]-1, and include both the edges that leave i in the
+ * original graph and the reverse edges of the ones that lead to it. */
+typedef struct residual {
+    unsigned int n;
+    unsigned int source, sink;
+
+    unsigned long *offsets;
+
+    /* Vertex each arc leads to */
+    unsigned int *head;
+
+    /* Position of the reverse of each arc */
+    unsigned long *pair;
+
+    /* Capacity left on each arc */
+    double *cap;
+
+    /* Position of the arc for each edge of the original graph (in CSR
+     * order). Its reverse arc starts with no capacity, so the capacity
+     * of the reverse arc is the flow through the edge. */
+    unsigned long *edge_arc;
+    unsigned long n_edges;
+} residual_t;
+
+
+/*
+ * Helper function: frees a residual graph
+ *
+ * Parameters:
+ *  - r: The residual graph
+ */
+static void residual_free(residual_t *r)
+{
+    free(r->offsets);
+    free(r->head);
+    free(r->pair);
+    free(r->cap);
+    free(r->edge_arc);
+}
+
+
+/*
+ * Helper function: builds the residual graph of a graph, with no flow
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - source, sink: The source and the sink
+ *  - r: Out parameter for the residual graph
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EINVAL: If an edge has a negative weight
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int residual_init(graph_t *g, unsigned int source, unsigned int sink, residual_t *r)
+{
+    unsigned int n = g->n_vertices;
+    unsigned long m = g->n_edges;
+
+    r->n = n;
+    r->source = source;
+    r->sink = sink;
+    r->n_edges = m;
+    r->offsets = calloc(n + 1, sizeof(unsigned long));
+    r->head = malloc((m > 0 ? 2 * m : 1) * sizeof(unsigned int));
+    r->pair = malloc((m > 0 ? 2 * m : 1) * sizeof(unsigned long));
+    r->cap = malloc((m > 0 ? 2 * m : 1) * sizeof(double));
+    r->edge_arc = malloc((m > 0 ? m : 1) * sizeof(unsigned long));
+    unsigned long *next = malloc(n * sizeof(unsigned long));
+
+    if(r->offsets == NULL || r->head == NULL || r->pair == NULL ||
+       r->cap == NULL || r->edge_arc == NULL || next == NULL)
+    {
+        free(next);
+        residual_free(r);
+        return ENOMEM;
+    }
+
+    /* Every edge gives an arc to each of its endpoints. Count them
+     * (as in graph_freeze_transpose, the count for vertex i goes in
+     * offsets[i+1], so adding up the counts gives the offsets). */
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            if(e->weight < 0)
+            {
+                free(next);
+                residual_free(r);
+                return EINVAL;
+            }
+
+            r->offsets[i + 1]++;
+            r->offsets[e->to - g->vertices + 1]++;
+        }
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        r->offsets[i + 1] += r->offsets[i];
+        next[i] = r->offsets[i];
+    }
+
+    unsigned long k = 0;
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next, k++)
+        {
+            unsigned int j = e->to - g->vertices;
+            unsigned long a = next[i]++;
+            unsigned long b = next[j]++;
+
+            r->head[a] = j;
+            r->cap[a] = e->weight;
+            r->pair[a] = b;
+
+            r->head[b] = i;
+            r->cap[b] = 0.0;
+            r->pair[b] = a;
+
+            r->edge_arc[k] = a;
+        }
+
+    free(next);
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: sends flow through an arc
+ *
+ * Parameters:
+ *  - r: The residual graph
+ *  - a: The arc
+ *  - f: The amount to send (at most the capacity left on the arc)
+ */
+static inline void residual_push(residual_t *r, unsigned long a, double f)
+{
+    r->cap[a] -= f;
+    r->cap[r->pair[a]] += f;
+}
+
+
+/*
+ * Helper function: computes the distances between every vertex and a
+ * target vertex in a residual graph (following arcs with capacity left)
+ *
+ * Parameters:
+ *  - r: The residual graph
+ *  - target: The target vertex
+ *  - reverse: If false, computes distances from the target to every
+ *             vertex. If true, from every vertex to the target.
+ *  - base: Added to every distance
+ *  - dist: Distance of every vertex. Only the vertices set to
+ *          FLOW_NONE are updated (if the target is not one of
+ *          them, nothing is), and the ones that cannot be reached
+ *          are left that way.
+ *  - queue: Array of r->n entries, used as the BFS queue
+ */
+static void residual_bfs(residual_t *r, unsigned int target, bool reverse,
+                         unsigned int base, unsigned int *dist, unsigned int *queue)
+{
+    unsigned int q_head = 0, q_tail = 0;
+
+    if(dist[target] != FLOW_NONE)
+        return;
+
+    dist[target] = base;
+    queue[q_tail++] = target;
+
+    while(q_head < q_tail)
+    {
+        unsigned int i = queue[q_head++];
+
+        for(unsigned long a = r->offsets[i]; a < r->offsets[i + 1]; a++)
+        {
+            unsigned int j = r->head[a];
+
+            /* Going backwards, j can reach i if the reverse arc
+             * (from j to i) has capacity left */
+            double cap = reverse ? r->cap[r->pair[a]] : r->cap[a];
+
+            if(cap > 0 && dist[j] == FLOW_NONE)
+            {
+                dist[j] = dist[i] + 1;
+                queue[q_tail++] = j;
+            }
+        }
+    }
+}
+
+
+/*
+ * Helper function: finds a maximum flow with Dinic's algorithm
+ *
+ * Each phase computes the distance of every vertex from the source, and
+ * then finds a blocking flow in the level graph (the arcs that go from
+ * one level to the next). The paths are found by an iterative DFS that
+ * remembers, for each vertex, the first arc it has not given up on yet.
+ *
+ * Parameters:
+ *  - r: The residual graph (with no flow)
+ *  - value: Out parameter for the value of the flow
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int dinic(residual_t *r, double *value)
+{
+    unsigned int n = r->n;
+    unsigned int *level = malloc(n * sizeof(unsigned int));
+    unsigned int *queue = malloc(n * sizeof(unsigned int));
+    unsigned long *current = malloc(n * sizeof(unsigned long));
+    unsigned long *path = malloc(n * sizeof(unsigned long));
+
+    if(level == NULL || queue == NULL || current == NULL || path == NULL)
+    {
+        free(level);
+        free(queue);
+        free(current);
+        free(path);
+        return ENOMEM;
+    }
+
+    *value = 0.0;
+
+    while(true)
+    {
+        for(unsigned int i = 0; i < n; i++)
+        {
+            level[i] = FLOW_NONE;
+            current[i] = r->offsets[i];
+        }
+
+        residual_bfs(r, r->source, false, 0, level, queue);
+        if(level[r->sink] == FLOW_NONE)
+            break;
+
+        /* The path is a stack of arcs from the source to vertex i */
+        unsigned int i = r->source, len = 0;
+
+        while(true)
+        {
+            if(i == r->sink)
+            {
+                double f = r->cap[path[0]];
+                for(unsigned int k = 1; k < len; k++)
+                    if(r->cap[path[k]] < f)
+                        f = r->cap[path[k]];
+
+                for(unsigned int k = 0; k < len; k++)
+                    residual_push(r, path[k], f);
+
+                *value += f;
+
+                /* Go back to the start of the first arc that is now full */
+                for(unsigned int k = 0; k < len; k++)
+                    if(r->cap[path[k]] == 0)
+                    {
+                        len = k;
+                        break;
+                    }
+
+                i = len > 0 ? r->head[path[len - 1]] : r->source;
+                continue;
+            }
+
+            /* Find an arc to the next level with capacity left */
+            for(; current[i] < r->offsets[i + 1]; current[i]++)
+            {
+                unsigned long a = current[i];
+                if(r->cap[a] > 0 && level[r->head[a]] == level[i] + 1)
+                    break;
+            }
+
+            if(current[i] < r->offsets[i + 1])
+            {
+                path[len++] = current[i];
+                i = r->head[current[i]];
+                continue;
+            }
+
+            /* Dead end: no more paths to the sink go through i */
+            if(i == r->source)
+                break;
+
+            level[i] = FLOW_NONE;
+            len--;
+            i = r->head[r->pair[path[len]]];
+            current[i]++;
+        }
+    }
+
+    free(level);
+    free(queue);
+    free(current);
+    free(path);
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: recomputes the heights used by the push-relabel
+ * algorithm (global relabeling). The height of each vertex that can
+ * reach the sink is its distance to the sink. The other vertices
+ * (whose excess can only go back to the source) get n plus their
+ * distance to the source, and the ones that cannot reach either,
+ * which have no excess, get 2n so nothing is ever pushed to them.
+ *
+ * Parameters:
+ *  - r: The residual graph
+ *  - height: The heights
+ *  - current: The current arc of each vertex (reset to the first one)
+ *  - queue: Array of r->n entries, used as the BFS queue
+ */
+static void push_relabel_global(residual_t *r, unsigned int *height,
+                                unsigned long *current, unsigned int *queue)
+{
+    unsigned int n = r->n;
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        height[i] = FLOW_NONE;
+        current[i] = r->offsets[i];
+    }
+
+    /* The source must keep its height of n */
+    height[r->source] = n;
+    residual_bfs(r, r->sink, true, 0, height, queue);
+
+    height[r->source] = FLOW_NONE;
+    residual_bfs(r, r->source, true, n, height, queue);
+
+    for(unsigned int i = 0; i < n; i++)
+        if(height[i] == FLOW_NONE)
+            height[i] = 2 * n;
+}
+
+
+/*
+ * Helper function: finds a maximum flow with the push-relabel algorithm
+ *
+ * Parameters:
+ *  - r: The residual graph (with no flow)
+ *  - value: Out parameter for the value of the flow
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int push_relabel(residual_t *r, double *value)
+{
+    unsigned int n = r->n;
+    unsigned int *height = malloc(n * sizeof(unsigned int));
+    unsigned int *queue = malloc(n * sizeof(unsigned int));
+    unsigned long *current = malloc(n * sizeof(unsigned long));
+    double *excess = calloc(n, sizeof(double));
+
+    /* The active vertices (the ones with excess, other than the source
+     * and the sink) are kept in a FIFO, which is a circular buffer. Each
+     * vertex is in it at most once, so n entries are enough. */
+    unsigned int *fifo = malloc(n * sizeof(unsigned int));
+    bool *active = calloc(n, sizeof(bool));
+    unsigned int f_head = 0, f_len = 0;
+
+    if(height == NULL || queue == NULL || current == NULL ||
+       excess == NULL || fifo == NULL || active == NULL)
+    {
+        free(height);
+        free(queue);
+        free(current);
+        free(excess);
+        free(fifo);
+        free(active);
+        return ENOMEM;
+    }
+
+    /* Start by filling every arc that leaves the source */
+    for(unsigned long a = r->offsets[r->source]; a < r->offsets[r->source + 1]; a++)
+    {
+        unsigned int j = r->head[a];
+        double f = r->cap[a];
+
+        if(f <= 0)
+            continue;
+
+        residual_push(r, a, f);
+        excess[j] += f;
+        excess[r->source] -= f;
+
+        if(!active[j] && j != r->source && j != r->sink)
+        {
+            active[j] = true;
+            fifo[(f_head + f_len++) % n] = j;
+        }
+    }
+
+    push_relabel_global(r, height, current, queue);
+
+    unsigned int relabels = 0;
+
+    while(f_len > 0)
+    {
+        unsigned int i = fifo[f_head];
+        f_head = (f_head + 1) % n;
+        f_len--;
+        active[i] = false;
+
+        /* Discharge i: push its excess to lower neighbours,
+         * relabelling it when there are none left */
+        while(excess[i] > 0)
+        {
+            if(current[i] == r->offsets[i + 1])
+            {
+                unsigned int h = FLOW_NONE;
+
+                for(unsigned long a = r->offsets[i]; a < r->offsets[i + 1]; a++)
+                    if(r->cap[a] > 0 && height[r->head[a]] < h)
+                        h = height[r->head[a]];
+
+                /* With exact arithmetic, any excess can be sent back to
+                 * the source, so heights stay below 2n. Excess that
+                 * cannot is rounding error in the capacities, and is
+                 * dropped (otherwise it would go round in circles). */
+                if(h == FLOW_NONE || h + 1 >= 2 * n)
+                {
+                    excess[i] = 0.0;
+                    break;
+                }
+
+                height[i] = h + 1;
+                current[i] = r->offsets[i];
+
+                if(++relabels == n)
+                {
+                    push_relabel_global(r, height, current, queue);
+                    relabels = 0;
+                }
+
+                continue;
+            }
+
+            unsigned long a = current[i];
+            unsigned int j = r->head[a];
+
+            if(r->cap[a] <= 0 || height[i] != height[j] + 1)
+            {
+                current[i]++;
+                continue;
+            }
+
+            double f = excess[i] < r->cap[a] ? excess[i] : r->cap[a];
+
+            residual_push(r, a, f);
+            excess[i] -= f;
+            excess[j] += f;
+
+            if(!active[j] && j != r->source && j != r->sink)
+            {
+                active[j] = true;
+                fifo[(f_head + f_len++) % n] = j;
+            }
+        }
+    }
+
+    *value = excess[r->sink];
+
+    free(height);
+    free(queue);
+    free(current);
+    free(excess);
+    free(fifo);
+    free(active);
+
+    return SUCCESS;
+}
+
+
+/* See flow.h */
+int graph_max_flow(graph_t *g, unsigned int source, unsigned int sink,
+                   int algorithm, graph_flow_t *flow)
+{
+    residual_t r;
+    int rc;
+
+    flow->flow = NULL;
+    flow->source_side = NULL;
+
+    if(source >= g->n_vertices || sink >= g->n_vertices)
+        return EINDEX;
+
+    if(source == sink || (algorithm != GRAPH_FLOW_DINIC && algorithm != GRAPH_FLOW_PUSH_RELABEL))
+        return EINVAL;
+
+    rc = residual_init(g, source, sink, &r);
+    if(rc != SUCCESS)
+        return rc;
+
+    if(algorithm == GRAPH_FLOW_DINIC)
+        rc = dinic(&r, &flow->value);
+    else
+        rc = push_relabel(&r, &flow->value);
+
+    unsigned int *dist = malloc(g->n_vertices * sizeof(unsigned int));
+    unsigned int *queue = malloc(g->n_vertices * sizeof(unsigned int));
+
+    flow->n_edges = r.n_edges;
+    flow->flow = malloc((r.n_edges > 0 ? r.n_edges : 1) * sizeof(double));
+    flow->source_side = malloc(g->n_vertices * sizeof(bool));
+
+    if(rc == SUCCESS && (dist == NULL || queue == NULL ||
+                         flow->flow == NULL || flow->source_side == NULL))
+        rc = ENOMEM;
+
+    if(rc == SUCCESS)
+    {
+        for(unsigned long k = 0; k < r.n_edges; k++)
+            flow->flow[k] = r.cap[r.pair[r.edge_arc[k]]];
+
+        /* The minimum cut separates the vertices that can still be
+         * reached from the source from the ones that cannot */
+        for(unsigned int i = 0; i < g->n_vertices; i++)
+            dist[i] = FLOW_NONE;
+
+        residual_bfs(&r, source, false, 0, dist, queue);
+
+        for(unsigned int i = 0; i < g->n_vertices; i++)
+            flow->source_side[i] = dist[i] != FLOW_NONE;
+    }
+
+    free(dist);
+    free(queue);
+    residual_free(&r);
+
+    if(rc != SUCCESS)
+        graph_flow_free(flow);
+
+    return rc;
+}
+
+
+/* See flow.h */
+int graph_flow_free(graph_flow_t *flow)
+{
+    free(flow->flow);
+    free(flow->source_side);
+
+    flow->flow = NULL;
+    flow->source_side = NULL;
+
+    return SUCCESS;
+}
@@ -0,0 +1,245 @@
+#include "generators.h"
+#include <stdlib.h>
+
+
+/*
+ * Helper function: returns the next number of a splitmix64 sequence,
+ * which is fast and good enough for generating graphs
+ *
+ * Parameters:
+ *  - state: The state of the generator, which is updated
+ *
+ * Returns:
+ *  - A random 64-bit number
+ */
+static unsigned long long gen_next(unsigned long long *state)
+{
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+    return z ^ (z >> 31);
+}
+
+
+/* Helper function: returns a random number between 0 and n-1 */
+static unsigned int gen_below(unsigned long long *state, unsigned int n)
+{
+    return ((gen_next(state) >> 32) * n) >> 32;
+}
+
+
+/* Helper function: returns a random number between 0 (inclusive) and 1 (exclusive) */
+static double gen_uniform(unsigned long long *state)
+{
+    return (gen_next(state) >> 11) * 0x1.0p-53;
+}
+
+
+/* Helper function: returns a random edge weight */
+static double gen_weight(unsigned long long *state)
+{
+    return 1 + gen_below(state, GRAPH_GEN_MAX_WEIGHT);
+}
+
+
+/*
+ * Helper function: initializes a graph, and reserves memory for its edges
+ *
+ * Parameters:
+ *  - g: The graph to initialize
+ *  - n: The number of vertices
+ *  - n_edges: The number of edges
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory (if so, the graph is
+ *    left uninitialized)
+ */
+static int gen_init(graph_t *g, unsigned int n, unsigned long n_edges)
+{
+    int rc = graph_init(g, n);
+    if(rc != SUCCESS)
+        return rc;
+
+    rc = graph_reserve_edges(g, n_edges);
+    if(rc != SUCCESS)
+        graph_free(g);
+
+    return rc;
+}
+
+
+/* See generators.h */
+int graph_gen_rmat(graph_t *g, unsigned int scale, unsigned int edge_factor,
+                   double a, double b, double c, unsigned long seed)
+{
+    unsigned long long state = seed;
+
+    if(scale == 0 || scale > 31 || a < 0 || b < 0 || c < 0 || a + b + c > 1)
+        return EINVAL;
+
+    unsigned int n = 1u << scale;
+    unsigned long n_edges = (unsigned long) edge_factor << scale;
+
+    /* The shuffled index of each vertex */
+    unsigned int *perm = malloc(n * sizeof(unsigned int));
+    if(perm == NULL)
+        return ENOMEM;
+
+    for(unsigned int i = 0; i < n; i++)
+        perm[i] = i;
+
+    for(unsigned int i = n - 1; i > 0; i--)
+    {
+        unsigned int j = gen_below(&state, i + 1);
+        unsigned int tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+    }
+
+    int rc = gen_init(g, n, n_edges);
+
+    for(unsigned long k = 0; rc == SUCCESS && k < n_edges; k++)
+    {
+        unsigned int from = 0, to = 0;
+
+        /* Each level picks one bit of each index */
+        for(unsigned int bit = 1u << (scale - 1); bit != 0; bit >>= 1)
+        {
+            double r = gen_uniform(&state);
+
+            if(r >= a + b + c)
+            {
+                from |= bit;
+                to |= bit;
+            }
+            else if(r >= a + b)
+                from |= bit;
+            else if(r >= a)
+                to |= bit;
+        }
+
+        rc = graph_add_edge(g, perm[from], perm[to], gen_weight(&state));
+        if(rc != SUCCESS)
+            graph_free(g);
+    }
+
+    free(perm);
+
+    return rc;
+}
+
+
+/* See generators.h */
+int graph_gen_erdos_renyi(graph_t *g, unsigned int n, unsigned long m, unsigned long seed)
+{
+    unsigned long long state = seed;
+
+    if(n == 0 || (n == 1 && m > 0))
+        return EINVAL;
+
+    int rc = gen_init(g, n, m);
+
+    for(unsigned long k = 0; rc == SUCCESS && k < m; k++)
+    {
+        /* Picking the target among the other n-1 vertices avoids loops */
+        unsigned int from = gen_below(&state, n);
+        unsigned int to = gen_below(&state, n - 1);
+
+        if(to >= from)
+            to++;
+
+        rc = graph_add_edge(g, from, to, gen_weight(&state));
+        if(rc != SUCCESS)
+            graph_free(g);
+    }
+
+    return rc;
+}
+
+
+/* See generators.h */
+int graph_gen_grid(graph_t *g, unsigned int rows, unsigned int cols, unsigned long seed)
+{
+    unsigned long long state = seed;
+
+    if(rows == 0 || cols == 0 || (unsigned long) rows * cols >= GRAPH_NO_VERTEX)
+        return EINVAL;
+
+    unsigned long n_edges = 2 * ((unsigned long) rows * (cols - 1) +
+                                 (unsigned long) (rows - 1) * cols);
+
+    int rc = gen_init(g, rows * cols, n_edges);
+
+    for(unsigned int r = 0; rc == SUCCESS && r < rows; r++)
+        for(unsigned int c = 0; rc == SUCCESS && c < cols; c++)
+        {
+            unsigned int i = r * cols + c;
+            double weight;
+
+            if(c + 1 < cols)
+            {
+                weight = gen_weight(&state);
+                rc = graph_add_edge(g, i, i + 1, weight);
+                if(rc == SUCCESS)
+                    rc = graph_add_edge(g, i + 1, i, weight);
+            }
+
+            if(rc == SUCCESS && r + 1 < rows)
+            {
+                weight = gen_weight(&state);
+                rc = graph_add_edge(g, i, i + cols, weight);
+                if(rc == SUCCESS)
+                    rc = graph_add_edge(g, i + cols, i, weight);
+            }
+
+            if(rc != SUCCESS)
+                graph_free(g);
+        }
+
+    return rc;
+}
+
+
+/* See generators.h */
+int graph_gen_chain_dag(graph_t *g, unsigned int n, unsigned long extra, unsigned long seed)
+{
+    unsigned long long state = seed;
+
+    if(n == 0 || (n == 1 && extra > 0))
+        return EINVAL;
+
+    int rc = gen_init(g, n, n - 1 + extra);
+
+    for(unsigned int i = 0; rc == SUCCESS && i + 1 < n; i++)
+    {
+        rc = graph_add_edge(g, i, i + 1, gen_weight(&state));
+        if(rc != SUCCESS)
+            graph_free(g);
+    }
+
+    for(unsigned long k = 0; rc == SUCCESS && k < extra; k++)
+    {
+        /* Edges always go from the lower index to the higher one */
+        unsigned int from = gen_below(&state, n);
+        unsigned int to = gen_below(&state, n - 1);
+
+        if(to >= from)
+            to++;
+
+        if(to < from)
+        {
+            unsigned int tmp = from;
+            from = to;
+            to = tmp;
+        }
+
+        rc = graph_add_edge(g, from, to, gen_weight(&state));
+        if(rc != SUCCESS)
+            graph_free(g);
+    }
+
+    return rc;
+}
@@ -1,329 +1,1979 @@
 #include "graph.h"
+#include "counters.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* LABEL MAP
+ *
+ * The label map is an open-addressing hash table (with linear probing)
+ * from vertex labels to vertex indices. Slots store the vertex index plus
+ * one, so a zero slot is empty. If several vertices share a label, the map
+ * points to the one with the lowest index (which is the one a linear scan
+ * over the vertices would find first), and the slot's entry in label_dups
+ * counts the others. Only removing the vertex a shared label points to
+ * requires looking for the next one, so unique labels (the common case)
+ * are removed in O(1) expected time.
+ *
+ * Labels are stored truncated to MAX_LABEL_LEN characters, so only that
+ * many characters of a label are ever hashed or compared.
+ */
+
+/* Minimum number of slots in the label map */
+#define LABEL_MAP_MIN_SIZE (16)
+
+
+/*
+ * Helper function: hashes a label (FNV-1a)
+ *
+ * Parameters:
+ *  - label: The label
+ *  - len: Number of characters in the label (at most MAX_LABEL_LEN)
+ *
+ * Returns:
+ *  - The hash value
+ */
+static unsigned int label_hash(const char *label, size_t len)
+{
+    unsigned int h = 2166136261u;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char) label[i];
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+
+/*
+ * Helper function: finds the slot for a label in the label map
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - label: The label (does not need to be NUL-terminated)
+ *  - len: Number of characters in the label (at most MAX_LABEL_LEN)
+ *
+ * Returns:
+ *  - The index of the slot containing the label if it is in the map.
+ *    Otherwise, the index of the empty slot where it would be inserted.
+ *    The label map must have been allocated.
+ */
+static unsigned int label_map_slot(graph_t *g, const char *label, size_t len)
+{
+    unsigned int mask = g->label_map_size - 1;
+    unsigned int slot = label_hash(label, len) & mask;
+
+    while(g->label_map[slot] != 0)
+    {
+        const char *other = g->vertices[g->label_map[slot] - 1].label;
+
+        if(strncmp(other, label, len) == 0 && other[len] == '\0')
+            break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+
+/*
+ * Helper function: finds the index of a vertex in the label map
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - label: The label (does not need to be NUL-terminated)
+ *  - len: Number of characters in the label (at most MAX_LABEL_LEN)
+ *
+ * Returns:
+ *  - If there is a vertex with the given label, returns its index
+ *  - Otherwise, returns ENOTFOUND
+ */
+static int label_map_find(graph_t *g, const char *label, size_t len)
+{
+    unsigned int slot;
+
+    if(g->label_map == NULL)
+        return ENOTFOUND;
+
+    slot = label_map_slot(g, label, len);
+    if(g->label_map[slot] == 0)
+        return ENOTFOUND;
+
+    return g->label_map[slot] - 1;
+}
+
+
+/*
+ * Helper function: resizes the label map, rehashing every entry
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - size: The new number of slots. Must be a power of two, and
+ *          larger than the number of entries in the map.
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int label_map_resize(graph_t *g, unsigned int size)
+{
+    unsigned int *old_map = g->label_map;
+    unsigned int *old_dups = g->label_dups;
+    unsigned int old_size = g->label_map_size;
+
+    /* The map and the duplicate counts share a single allocation */
+    g->label_map = calloc(2 * (size_t) size, sizeof(unsigned int));
+    if(g->label_map == NULL)
+    {
+        g->label_map = old_map;
+        return ENOMEM;
+    }
+    STATS_ALLOC(1);
+    g->label_dups = g->label_map + size;
+    g->label_map_size = size;
+
+    for(unsigned int i = 0; i < old_size; i++)
+    {
+        if(old_map[i] != 0)
+        {
+            const char *label = g->vertices[old_map[i] - 1].label;
+            size_t len = strlen(label);
+            unsigned int slot = label_map_slot(g, label, len);
+
+            g->label_map[slot] = old_map[i];
+            g->label_dups[slot] = old_dups[i];
+        }
+    }
+
+    free(old_map);
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: adds vertex i to the label map, under its
+ * current label (which must not be NULL)
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - i: Index of vertex
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int label_map_insert(graph_t *g, unsigned int i)
+{
+    const char *label = g->vertices[i].label;
+    size_t len = strlen(label);
+    unsigned int slot;
+    int rc;
+
+    /* Keep the load factor at or below 1/2 */
+    if(2 * (g->label_map_count + 1) > g->label_map_size)
+    {
+        unsigned int size = LABEL_MAP_MIN_SIZE;
+
+        while(size < 2 * g->n_vertices || size < 4 * (g->label_map_count + 1))
+            size *= 2;
+
+        rc = label_map_resize(g, size);
+        if(rc != SUCCESS)
+            return rc;
+    }
+
+    slot = label_map_slot(g, label, len);
+
+    if(g->label_map[slot] == 0)
+    {
+        g->label_map[slot] = i + 1;
+        g->label_map_count++;
+    }
+    else
+    {
+        /* Duplicate label: the lowest index wins */
+        g->label_dups[slot]++;
+        if(g->label_map[slot] - 1 > i)
+            g->label_map[slot] = i + 1;
+    }
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: removes vertex i from the label map, under its
+ * current label (which must not be NULL). If another vertex has the
+ * same label, the map is updated to point to it (which takes O(V) time,
+ * but only if the label is shared and vertex i is the one in the map).
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - i: Index of vertex
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+static int label_map_remove(graph_t *g, unsigned int i)
+{
+    const char *label = g->vertices[i].label;
+    size_t len = strlen(label);
+    unsigned int mask = g->label_map_size - 1;
+    unsigned int slot, next;
+
+    if(g->label_map == NULL)
+        return SUCCESS;
+
+    slot = label_map_slot(g, label, len);
+    if(g->label_map[slot] == 0)
+        return SUCCESS;
+
+    if(g->label_dups[slot] > 0)
+    {
+        g->label_dups[slot]--;
+
+        /* If vertex i was the one in the map, point the slot to the
+         * next vertex with this label (all of them have higher indices) */
+        if(g->label_map[slot] == i + 1)
+            for(unsigned int j = i + 1; j < g->n_vertices; j++)
+                if(g->vertices[j].label != NULL && strcmp(g->vertices[j].label, label) == 0)
+                {
+                    g->label_map[slot] = j + 1;
+                    break;
+                }
+
+        return SUCCESS;
+    }
+
+    /* Backward-shift deletion: move later entries of the probe
+     * sequence into the hole, so lookups never stop early */
+    g->label_map[slot] = 0;
+    g->label_map_count--;
+
+    next = (slot + 1) & mask;
+    while(g->label_map[next] != 0)
+    {
+        const char *other = g->vertices[g->label_map[next] - 1].label;
+        unsigned int home = label_hash(other, strlen(other)) & mask;
+
+        /* The entry can fill the hole if its home slot is not
+         * cyclically in (slot, next] */
+        if(((next - home) & mask) >= ((next - slot) & mask))
+        {
+            g->label_map[slot] = g->label_map[next];
+            g->label_dups[slot] = g->label_dups[next];
+            g->label_map[next] = 0;
+            g->label_dups[next] = 0;
+            slot = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+
+    return SUCCESS;
+}
+
+
+/* EDGE SLABS
+ *
+ * Edges are allocated by bumping a pointer into the most recent slab.
+ * When that slab is full, a new one is allocated, twice as large as the
+ * previous one (up to EDGE_SLAB_MAX edges).
+ *
+ * Removed edges go into a free list (linked through their 'next' field,
+ * and with 'to' set to NULL), and are reused before bumping the pointer.
+ */
+
+/* Number of edges in the first slab of a graph */
+#define EDGE_SLAB_MIN (64)
+
+/* Maximum number of edges in a slab allocated by graph_add_edge
+ * (graph_reserve_edges can allocate larger slabs) */
+#define EDGE_SLAB_MAX (65536)
+
+/* Shortest possible edge line in a text file ("a b 1\n"), used to bound
+ * the number of edges reserved from the header of a file */
+#define MIN_EDGE_LINE_LEN (6)
+
+/* Estimate of the memory used by malloc for an allocation of n bytes,
+ * including its header and alignment padding (as done by glibc) */
+#define MALLOC_CHUNK_SIZE(n) ((n) + sizeof(size_t) <= 32 ? 32 : \
+                              ((n) + sizeof(size_t) + 15) & ~((size_t) 15))
+
+
+/*
+ * Helper function: allocates a new slab and makes it the current one
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - capacity: Number of edges in the slab
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int edge_slab_alloc(graph_t *g, unsigned long capacity)
+{
+    edge_slab_t *slab = malloc(sizeof(edge_slab_t) + capacity * sizeof(edge_t));
+
+    if(slab == NULL)
+        return ENOMEM;
+
+    STATS_ALLOC(1);
+
+    slab->used = 0;
+    slab->capacity = capacity;
+    slab->next = g->edge_slabs;
+    g->edge_slabs = slab;
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: allocates an edge
+ *
+ * Parameters:
+ *  - g: The graph
+ *
+ * Returns:
+ *  - A pointer to an uninitialized edge_t
+ *  - NULL if there was insufficient memory
+ */
+static edge_t *edge_alloc(graph_t *g)
+{
+    edge_slab_t *slab = g->edge_slabs;
+
+    if(g->free_edges != NULL)
+    {
+        edge_t *e = g->free_edges;
+        g->free_edges = e->next;
+        return e;
+    }
+
+    if(slab == NULL || slab->used == slab->capacity)
+    {
+        unsigned long capacity = EDGE_SLAB_MIN;
+
+        if(slab != NULL && slab->capacity >= EDGE_SLAB_MIN)
+            capacity = slab->capacity < EDGE_SLAB_MAX / 2 ? 2 * slab->capacity : EDGE_SLAB_MAX;
+
+        if(edge_slab_alloc(g, capacity) != SUCCESS)
+            return NULL;
+
+        slab = g->edge_slabs;
+    }
+
+    return &slab->edges[slab->used++];
+}
+
+
+/*
+ * Helper function: frees an edge, adding it to the free list
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - e: The edge (which must not be in any list of edges)
+ */
+static void edge_free(graph_t *g, edge_t *e)
+{
+    e->to = NULL;
+    e->next = g->free_edges;
+    g->free_edges = e;
+}
+
+
+/* ADJACENCY INDEXES
+ *
+ * A vertex gets an adjacency index once its out-degree reaches the
+ * graph's index threshold. The index is kept at most half full, and
+ * doubles in size when it gets there. Indexes are an optimization: if
+ * one can't be built or grown, the vertex is left without one, and
+ * lookups fall back to walking the list of edges.
+ */
+
+/* Minimum number of slots in an adjacency index */
+#define EDGE_INDEX_MIN_SIZE (64)
+
+
+/*
+ * Helper function: returns the home slot of a target vertex in an index
+ * (the slot where probing for it starts)
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - index: The index
+ *  - to: The target vertex
+ *
+ * Returns:
+ *  - The home slot
+ */
+static unsigned int edge_index_home(graph_t *g, edge_index_t *index, vertex_t *to)
+{
+    /* Vertex indices are often consecutive, so mix their bits
+     * (Fibonacci hashing) before taking the low ones */
+    unsigned int h = (unsigned int) (to - g->vertices) * 2654435769u;
+
+    return (h ^ (h >> 16)) & (index->size - 1);
+}
+
+
+/*
+ * Helper function: finds the slot for a target vertex in an index
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - index: The index
+ *  - to: The target vertex
+ *
+ * Returns:
+ *  - The slot containing the edge to 'to', or the empty slot
+ *    where it would be inserted
+ */
+static unsigned int edge_index_slot(graph_t *g, edge_index_t *index, vertex_t *to)
+{
+    unsigned int mask = index->size - 1;
+    unsigned int slot = edge_index_home(g, index, to);
+
+    while(index->slots[slot] != NULL && index->slots[slot]->to != to)
+        slot = (slot + 1) & mask;
+
+    return slot;
+}
+
+
+/*
+ * Helper function: returns the number of slots for a new index
+ *
+ * Parameters:
+ *  - degree: Out-degree of the vertex
+ *
+ * Returns:
+ *  - The smallest power of two (at least EDGE_INDEX_MIN_SIZE)
+ *    that is more than twice the degree
+ */
+static unsigned int edge_index_size(unsigned int degree)
+{
+    unsigned int size = EDGE_INDEX_MIN_SIZE;
+
+    while(size <= 2 * degree)
+        size *= 2;
+
+    return size;
+}
+
+
+/*
+ * Helper function: (re)builds the adjacency index of a vertex
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - v: The vertex
+ *  - size: Number of slots (a power of two, more than twice the degree)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory (the vertex is
+ *    then left without an index)
+ */
+static int edge_index_build(graph_t *g, vertex_t *v, unsigned int size)
+{
+    free(v->index);
+
+    v->index = calloc(1, sizeof(edge_index_t) + size * sizeof(edge_t*));
+    if(v->index == NULL)
+        return ENOMEM;
+
+    STATS_ALLOC(1);
+
+    v->index->size = size;
+    v->index->count = 0;
+
+    /* Only the first edge to each vertex goes in the index */
+    for(edge_t *e = v->edges; e != NULL; e = e->next)
+    {
+        unsigned int slot = edge_index_slot(g, v->index, e->to);
+
+        if(v->index->slots[slot] == NULL)
+        {
+            v->index->slots[slot] = e;
+            v->index->count++;
+        }
+    }
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: updates the adjacency index of a vertex after
+ * an edge has been added at the head of its list of edges, building
+ * the index if the vertex has just reached the threshold
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - v: The vertex
+ */
+static void edge_index_add(graph_t *g, vertex_t *v)
+{
+    edge_index_t *index = v->index;
+
+    if(index == NULL)
+    {
+        if(g->index_threshold != 0 && v->degree >= g->index_threshold)
+            edge_index_build(g, v, edge_index_size(v->degree));
+        return;
+    }
+
+    if(2 * (index->count + 1) > index->size)
+    {
+        edge_index_build(g, v, 2 * index->size);
+        return;
+    }
+
+    /* The new edge is now the first edge to its target */
+    unsigned int slot = edge_index_slot(g, index, v->edges->to);
+
+    if(index->slots[slot] == NULL)
+        index->count++;
+    index->slots[slot] = v->edges;
+}
+
+
+/*
+ * Helper function: updates the adjacency index of a vertex before an
+ * edge is removed from its list of edges
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - v: The vertex
+ *  - e: The edge that will be removed (still in the list)
+ */
+static void edge_index_remove(graph_t *g, vertex_t *v, edge_t *e)
+{
+    edge_index_t *index = v->index;
+
+    if(index == NULL)
+        return;
+
+    unsigned int mask = index->size - 1;
+    unsigned int slot = edge_index_slot(g, index, e->to);
+
+    if(index->slots[slot] != e)
+        return;
+
+    /* If there is another edge to the same vertex, it comes later
+     * in the list, and now it is the first one */
+    for(edge_t *other = e->next; other != NULL; other = other->next)
+    {
+        if(other->to == e->to)
+        {
+            index->slots[slot] = other;
+            return;
+        }
+    }
+
+    /* Backward-shift deletion, as in label_map_remove */
+    index->slots[slot] = NULL;
+    index->count--;
+
+    unsigned int next = (slot + 1) & mask;
+    while(index->slots[next] != NULL)
+    {
+        unsigned int home = edge_index_home(g, index, index->slots[next]->to);
+
+        if(((next - home) & mask) >= ((next - slot) & mask))
+        {
+            index->slots[slot] = index->slots[next];
+            index->slots[next] = NULL;
+            slot = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+}
+
+
+/* See graph.h */
+int graph_init(graph_t *g, unsigned int n)
+{
+    if(n == 0)
+        return EINVAL;
+
+    g->n_vertices = n;
+    g->vertices_capacity = n;
+    g->n_removed = 0;
+
+    g->vertices = calloc(n, sizeof(vertex_t));
+
+    if(g->vertices == NULL)
+        return ENOMEM;
+
+    STATS_ALLOC(1);
+
+    g->label_map = NULL;
+    g->label_dups = NULL;
+    g->label_map_size = 0;
+    g->label_map_count = 0;
+    g->edge_slabs = NULL;
+    g->free_edges = NULL;
+    g->n_edges = 0;
+    g->index_threshold = GRAPH_INDEX_THRESHOLD;
+    g->version = 0;
+
+    return SUCCESS;
+}
+
+
+/* See graph.h */
+int graph_free(graph_t *g)
+{
+    for(unsigned int i=0; i < g->n_vertices; i++)
+    {
+        free(g->vertices[i].label);
+        free(g->vertices[i].index);
+    }
+
+    /* The edges are freed along with the slabs they were allocated from */
+    edge_slab_t *slab = g->edge_slabs;
+    while(slab != NULL)
+    {
+        edge_slab_t *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    free(g->vertices);
+    free(g->label_map);
+
+    return SUCCESS;
+}
+
+
+/* See graph.h */
+int graph_print(graph_t *g)
+{
+    for(unsigned int i=0; i < g->n_vertices; i++)
+    {
+        if(g->vertices[i].label == NULL)
+            printf("%i:", i);
+        else
+            printf("%s:", g->vertices[i].label);
+
+        edge_t *pe = g->vertices[i].edges;
+
+        while(pe != NULL)
+        {
+            if(pe->to->label == NULL)
+                printf(" -> %li", graph_vertex_index(g, pe->to));
+            else
+                printf(" -> %s", pe->to->label);
+
+            pe = pe->next;
+        }
+        printf("\n");
+    }
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: sets the label of a vertex, copying at most
+ * len characters of the label
+ *
+ * Parameters:
+ *  - g: A graph
+ *  - i: Index of vertex
+ *  - label: The label (does not need to be NUL-terminated)
+ *  - len: Maximum number of characters to copy
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ *  - EINDEX: If the provided index is invalid
+ */
+static int graph_set_label_n(graph_t *g, unsigned int i, const char *label, size_t len)
+{
+    /* Get vertex */
+    if(i >= g->n_vertices)
+        return EINDEX;
+
+    vertex_t *v = &g->vertices[i];
+    char *new_label = NULL;
+
+    if(len > MAX_LABEL_LEN)
+        len = MAX_LABEL_LEN;
+
+    if(label != NULL)
+    {
+        new_label = strndup(label, len);
+
+        if(new_label == NULL)
+            return ENOMEM;
+
+        STATS_ALLOC(1);
+    }
+
+    g->version++;
+
+    /* Free previous label, if one exists */
+    if(v->label != NULL)
+    {
+        label_map_remove(g, i);
+        free(v->label);
+    }
+
+    v->label = new_label;
+
+    /* Every label must be in the map (label_map_remove relies on the
+     * duplicate counts), so if it can't be added, the vertex is left
+     * without a label */
+    if(new_label != NULL && label_map_insert(g, i) != SUCCESS)
+    {
+        free(new_label);
+        v->label = NULL;
+        return ENOMEM;
+    }
+
+    return SUCCESS;
+}
+
+
+/* See graph.h */
+int graph_set_label(graph_t *g, unsigned int i, const char *label)
+{
+    if(i < g->n_vertices && g->vertices[i].removed)
+        return ENOTFOUND;
+
+    return graph_set_label_n(g, i, label, MAX_LABEL_LEN);
+}
+
+/* See graph.h */
+int graph_get_vertex(graph_t *g, unsigned int i, vertex_t **v)
+{
+    /* Get vertex */
+    if(i >= g->n_vertices)
+        return EINDEX;
+
+    *v = &g->vertices[i];
+
+    return SUCCESS;
+}
+
+/* See graph.h */
+long int graph_vertex_index(graph_t *g, vertex_t *v)
+{
+    long int i = (v) - (g)->vertices;
+
+    if(i < 0 || i >= g->n_vertices)
+        return ENOTFOUND;
+    else
+        return i;
+}
+
+/* See graph.h */
+int graph_add_edge(graph_t *g, unsigned int from, unsigned int to, double weight)
+{
+    /* Get vertices */
+    if(from >= g->n_vertices || to >= g->n_vertices)
+        return EINDEX;
+
+    vertex_t *from_v = &g->vertices[from];
+    vertex_t *to_v = &g->vertices[to];
+
+    if(from_v->removed || to_v->removed)
+        return ENOTFOUND;
+
+    /* Create edge */
+    edge_t *e = edge_alloc(g);
+
+    if(e == NULL)
+        return ENOMEM;
+
+    e->to = to_v;
+    e->weight = weight;
+
+    /* Add to edge list */
+    e->next = from_v->edges;
+    from_v->edges = e;
+    from_v->degree++;
+
+    edge_index_add(g, from_v);
+
+    g->n_edges++;
+    g->version++;
+
+    return SUCCESS;
+}
+
+
+/* See graph.h */
+int graph_reserve_edges(graph_t *g, unsigned long n)
+{
+    edge_slab_t *slab = g->edge_slabs;
+
+    if(n == 0 || (slab != NULL && slab->capacity - slab->used >= n))
+        return SUCCESS;
+
+    return edge_slab_alloc(g, n);
+}
+
+
+/*
+ * Helper function: reserves the edges announced in the header of a text
+ * file. The header is not trusted: the reservation is capped by the number
+ * of edge lines that fit in the rest of the file, and edge_alloc grows the
+ * slabs if the file does have more edges.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - n_edges: The number of edges in the header
+ *  - undirected: Whether each edge is stored twice
+ *  - bytes_left: The size of the rest of the file
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int graph_reserve_file_edges(graph_t *g, unsigned long n_edges, bool undirected,
+                                    unsigned long bytes_left)
+{
+    unsigned long max_edges = bytes_left / MIN_EDGE_LINE_LEN + 1;
+
+    if(n_edges > max_edges)
+        n_edges = max_edges;
+
+    return graph_reserve_edges(g, undirected ? 2 * n_edges : n_edges);
+}
+
+
+/*
+ * Helper function: retrieves an edge
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - from, to: The numerical indices of the vertices
+ *  - edge: Output parameter
+ *
+ * Returns:
+ *  - 0: If the vertices exist. If so, 'edge' is set to NULL
+ *    if there is no edge connecting them; otherwise, it will
+ *    point to the edge_t struct for that edge.
+ *  - EINDEX: If one of the provided indices is invalid
+ */
+static int graph_get_edge(graph_t *g, unsigned int from, unsigned int to, edge_t **e)
+{
+    /* Get vertices */
+    if(from >= g->n_vertices || to >= g->n_vertices)
+        return EINDEX;
+
+    vertex_t *from_v = &g->vertices[from];
+    vertex_t *to_v = &g->vertices[to];
+
+    /* Use the adjacency index if there is one */
+    if(from_v->index != NULL)
+    {
+        *e = from_v->index->slots[edge_index_slot(g, from_v->index, to_v)];
+        return SUCCESS;
+    }
+
+    /* Iterate over list of edges */
+    *e = from_v->edges;
+    while(*e != NULL)
+    {
+        if((*e)->to == to_v)
+            break;
+
+        *e = (*e)->next;
+    }
+
+    return SUCCESS;
+}
+
+
+/* See graph.h */
+int graph_is_vertex_adjacent(graph_t *g, unsigned int from, unsigned int to, double *weight)
+{
+    int rc;
+    edge_t *e;
+
+    rc = graph_get_edge(g, from, to, &e);
+    if(rc == EINDEX)
+        return EINDEX;
+
+    if(e == NULL)
+    {
+        return 0;
+    }
+    else
+    {
+        if(weight != NULL)
+            *weight = e->weight;
+
+        return 1;
+    }
+}
+
+
+/* See graph.h */
+int graph_num_vertex_with_loops(graph_t *g)
+{
+    int n_with_loops = 0;
+
+    for(unsigned int i=0; i < g->n_vertices; i++)
+    {
+        edge_t *e = g->vertices[i].edges;
+        while(e != NULL)
+        {
+            if(e->to == &g->vertices[i])
+            {
+                n_with_loops++;
+                break;
+            }
+
+            e = e->next;
+        }
+    }
+
+    return n_with_loops;
+}
+
+
+/* See graph.h */
+int graph_are_adjacent(graph_t *g, const vertex_pair_t *pairs, unsigned long n, int *out)
+{
+    for(unsigned long k = 0; k < n; k++)
+        out[k] = graph_is_vertex_adjacent(g, pairs[k].from, pairs[k].to, NULL);
+
+    return SUCCESS;
+}
+
+
+/* See graph.h */
+int graph_set_index_threshold(graph_t *g, unsigned int threshold)
+{
+    int rc = SUCCESS;
+
+    g->index_threshold = threshold;
+
+    for(unsigned int i = 0; i < g->n_vertices; i++)
+    {
+        vertex_t *v = &g->vertices[i];
+
+        if(threshold == 0 || v->degree < threshold)
+        {
+            free(v->index);
+            v->index = NULL;
+        }
+        else if(v->index == NULL)
+        {
+            if(edge_index_build(g, v, edge_index_size(v->degree)) != SUCCESS)
+                rc = ENOMEM;
+        }
+    }
+
+    return rc;
+}
+
+
+/* DYNAMIC GRAPHS
+ *
+ * Vertices are added at the end of the vertex array, which grows
+ * geometrically. When it is reallocated, the 'to' pointers of all the
+ * edges are rebased onto the new array, with a sequential pass over
+ * the edge slabs.
+ *
+ * Removed edges are unlinked right away. Removed vertices lose their
+ * label and all their edges, but keep their slot in the vertex array
+ * (as a tombstone), so the indices of the other vertices don't change
+ * until graph_compact is called.
+ */
+
+/* See graph.h */
+int graph_add_vertex(graph_t *g, const char *label, unsigned int *index)
+{
+    if(g->n_vertices == g->vertices_capacity)
+    {
+        unsigned int capacity = g->vertices_capacity * 2;
+        uintptr_t old = (uintptr_t) g->vertices;
+
+        if(capacity <= g->vertices_capacity)
+            return ENOMEM;
+
+        vertex_t *vertices = realloc(g->vertices, capacity * sizeof(vertex_t));
+        if(vertices == NULL)
+            return ENOMEM;
+
+        STATS_ALLOC(1);
+
+        /* Rebase the edges (including the free ones, whose 'to' is NULL) */
+        if((uintptr_t) vertices != old)
+            for(edge_slab_t *slab = g->edge_slabs; slab != NULL; slab = slab->next)
+                for(unsigned long k = 0; k < slab->used; k++)
+                {
+                    edge_t *e = &slab->edges[k];
+                    if(e->to != NULL)
+                        e->to = vertices + ((uintptr_t) e->to - old) / sizeof(vertex_t);
+                }
+
+        g->vertices = vertices;
+        g->vertices_capacity = capacity;
+    }
+
+    unsigned int i = g->n_vertices;
+
+    memset(&g->vertices[i], 0, sizeof(vertex_t));
+    g->n_vertices++;
+
+    if(label != NULL)
+    {
+        unsigned long version = g->version;
+        int rc = graph_set_label(g, i, label);
+
+        if(rc != SUCCESS)
+        {
+            g->n_vertices--;
+            g->version = version;
+            return rc;
+        }
+    }
+
+    g->version++;
+
+    if(index != NULL)
+        *index = i;
+
+    return SUCCESS;
+}
 
 
 /* See graph.h */
-int graph_init(graph_t *g, unsigned int n)
+int graph_remove_edge(graph_t *g, unsigned int from, unsigned int to)
 {
-    if(n == 0)
-        return EINVAL;
+    if(from >= g->n_vertices || to >= g->n_vertices)
+        return EINDEX;
 
-    g->n_vertices = n;
+    vertex_t *from_v = &g->vertices[from];
+    vertex_t *to_v = &g->vertices[to];
 
-    g->vertices = calloc(n, sizeof(vertex_t));
+    if(from_v->removed || to_v->removed)
+        return ENOTFOUND;
 
-    if(g->vertices == NULL)
-        return ENOMEM;
+    /* If there is an index, it can tell us quickly that there's no edge */
+    if(from_v->index != NULL &&
+       from_v->index->slots[edge_index_slot(g, from_v->index, to_v)] == NULL)
+        return ENOTFOUND;
+
+    /* Find the first edge to the target, and the link pointing to it */
+    edge_t **link = &from_v->edges;
+    while(*link != NULL && (*link)->to != to_v)
+        link = &(*link)->next;
+
+    edge_t *e = *link;
+    if(e == NULL)
+        return ENOTFOUND;
+
+    edge_index_remove(g, from_v, e);
+
+    *link = e->next;
+    from_v->degree--;
+    edge_free(g, e);
+
+    g->n_edges--;
+    g->version++;
 
     return SUCCESS;
 }
 
 
 /* See graph.h */
-int graph_free(graph_t *g)
+int graph_remove_vertex(graph_t *g, unsigned int i)
 {
-    for(unsigned int i=0; i < g->n_vertices; i++)
+    if(i >= g->n_vertices)
+        return EINDEX;
+
+    vertex_t *v = &g->vertices[i];
+
+    if(v->removed)
+        return ENOTFOUND;
+
+    graph_set_label_n(g, i, NULL, 0);
+
+    /* Remove the edges from the vertex */
+    edge_t *e = v->edges;
+    while(e != NULL)
     {
-        free(g->vertices[i].label);
+        edge_t *next = e->next;
+        edge_free(g, e);
+        g->n_edges--;
+        e = next;
+    }
 
-        edge_t *pe = g->vertices[i].edges;
-        while(pe != NULL)
+    v->edges = NULL;
+    v->degree = 0;
+    free(v->index);
+    v->index = NULL;
+
+    /* Remove the edges to the vertex */
+    for(unsigned int j = 0; j < g->n_vertices; j++)
+    {
+        vertex_t *u = &g->vertices[j];
+        edge_t **link = &u->edges;
+
+        while(*link != NULL)
         {
-            edge_t *next = pe->next;
-            free(pe);
-            pe = next;
+            e = *link;
+            if(e->to != v)
+            {
+                link = &e->next;
+                continue;
+            }
+
+            edge_index_remove(g, u, e);
+
+            *link = e->next;
+            u->degree--;
+            edge_free(g, e);
+            g->n_edges--;
         }
     }
 
-    free(g->vertices);
+    v->removed = true;
+    g->n_removed++;
+    g->version++;
 
     return SUCCESS;
 }
 
 
+/*
+ * Helper function: rebuilds a graph with its vertices renumbered (and
+ * possibly some of them dropped). The edges are moved into a single
+ * contiguous block, where the edges of each vertex are stored together,
+ * in list order and in the order of the new vertex indices, which makes
+ * traversing the rebuilt graph more cache-friendly.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - old_to_new: The new index of each vertex (GRAPH_NO_VERTEX for
+ *                vertices that are dropped, which must not have edges
+ *                to or from them)
+ *  - new_to_old: The old index of each vertex in the rebuilt graph
+ *  - n: Number of vertices in the rebuilt graph
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory (if this happens before
+ *    the graph is modified, the graph is left as it was)
+ */
+static int graph_rebuild(graph_t *g, const unsigned int *old_to_new,
+                         const unsigned int *new_to_old, unsigned int n)
+{
+    edge_slab_t *slab = NULL;
+    vertex_t *vertices = malloc((n > 0 ? n : 1) * sizeof(vertex_t));
+
+    if(g->n_edges > 0)
+        slab = malloc(sizeof(edge_slab_t) + g->n_edges * sizeof(edge_t));
+
+    if(vertices == NULL || (g->n_edges > 0 && slab == NULL))
+    {
+        free(vertices);
+        free(slab);
+        return ENOMEM;
+    }
+
+    /* Copy the vertices and their edges */
+    unsigned long pos = 0;
+    unsigned int n_removed = 0;
+
+    for(unsigned int i_new = 0; i_new < n; i_new++)
+    {
+        vertex_t *v = &g->vertices[new_to_old[i_new]];
+        vertex_t *new_v = &vertices[i_new];
+
+        if(v->removed)
+            n_removed++;
+
+        new_v->label = v->label;
+        new_v->degree = v->degree;
+        new_v->index = NULL;
+        new_v->removed = v->removed;
+        new_v->edges = NULL;
+
+        edge_t **link = &new_v->edges;
+        for(edge_t *e = v->edges; e != NULL; e = e->next)
+        {
+            edge_t *new_e = &slab->edges[pos++];
+            new_e->to = &vertices[old_to_new[e->to - g->vertices]];
+            new_e->weight = e->weight;
+            *link = new_e;
+            link = &new_e->next;
+        }
+        *link = NULL;
+    }
+
+    for(unsigned int i = 0; i < g->n_vertices; i++)
+        free(g->vertices[i].index);
+
+    /* Replace the old vertices and slabs */
+    edge_slab_t *old = g->edge_slabs;
+    while(old != NULL)
+    {
+        edge_slab_t *next = old->next;
+        free(old);
+        old = next;
+    }
+
+    if(slab != NULL)
+    {
+        slab->next = NULL;
+        slab->used = pos;
+        slab->capacity = g->n_edges;
+    }
+
+    free(g->vertices);
+    g->vertices = vertices;
+    g->n_vertices = n;
+    g->vertices_capacity = n > 0 ? n : 1;
+    g->n_removed = n_removed;
+    g->edge_slabs = slab;
+    g->free_edges = NULL;
+    g->version++;
+
+    /* Rebuild the label map and the adjacency indexes, which
+     * refer to the old indices and edges */
+    int rc = SUCCESS;
+
+    free(g->label_map);
+    g->label_map = NULL;
+    g->label_dups = NULL;
+    g->label_map_size = 0;
+    g->label_map_count = 0;
+
+    for(unsigned int i = 0; i < n && rc == SUCCESS; i++)
+        if(g->vertices[i].label != NULL)
+            rc = label_map_insert(g, i);
+
+    if(rc == SUCCESS)
+        rc = graph_set_index_threshold(g, g->index_threshold);
+
+    return rc;
+}
+
+
 /* See graph.h */
-int graph_print(graph_t *g)
+int graph_compact(graph_t *g, unsigned int *old_to_new)
 {
-    for(unsigned int i=0; i < g->n_vertices; i++)
+    unsigned int n = g->n_vertices - g->n_removed;
+    unsigned int *map = old_to_new;
+    int rc;
+
+    if(map == NULL)
+        map = malloc((g->n_vertices > 0 ? g->n_vertices : 1) * sizeof(unsigned int));
+
+    unsigned int *new_to_old = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+
+    if(map == NULL || new_to_old == NULL)
     {
-        if(g->vertices[i].label == NULL)
-            printf("%i:", i);
+        if(map != old_to_new)
+            free(map);
+        free(new_to_old);
+        return ENOMEM;
+    }
+
+    /* Number the vertices that are left */
+    unsigned int n_new = 0;
+    for(unsigned int i = 0; i < g->n_vertices; i++)
+    {
+        if(g->vertices[i].removed)
+            map[i] = GRAPH_NO_VERTEX;
         else
-            printf("%s:", g->vertices[i].label);
+        {
+            new_to_old[n_new] = i;
+            map[i] = n_new++;
+        }
+    }
 
-        edge_t *pe = g->vertices[i].edges;
+    rc = graph_rebuild(g, map, new_to_old, n);
 
-        while(pe != NULL)
-        {
-            if(pe->to->label == NULL)
-                printf(" -> %li", graph_vertex_index(g, pe->to));
-            else
-                printf(" -> %s", pe->to->label);
+    if(map != old_to_new)
+        free(map);
+    free(new_to_old);
 
-            pe = pe->next;
+    return rc;
+}
+
+
+/* See graph.h */
+int graph_permute(graph_t *g, const unsigned int *old_to_new)
+{
+    unsigned int n = g->n_vertices;
+    unsigned int *new_to_old = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    int rc;
+
+    if(new_to_old == NULL)
+        return ENOMEM;
+
+    for(unsigned int i = 0; i < n; i++)
+        new_to_old[i] = GRAPH_NO_VERTEX;
+
+    /* Check that every new index is used exactly once */
+    for(unsigned int i = 0; i < n; i++)
+    {
+        if(old_to_new[i] >= n || new_to_old[old_to_new[i]] != GRAPH_NO_VERTEX)
+        {
+            free(new_to_old);
+            return EINVAL;
         }
-        printf("\n");
+
+        new_to_old[old_to_new[i]] = i;
     }
 
-    return SUCCESS;
+    rc = graph_rebuild(g, old_to_new, new_to_old, n);
+
+    free(new_to_old);
+
+    return rc;
 }
 
 
 /* See graph.h */
-int graph_set_label(graph_t *g, unsigned int i, const char *label)
+int graph_edge_memory(graph_t *g, graph_mem_stats_t *stats)
 {
-    /* Get vertex */
-    if(i >= g->n_vertices)
-        return EINDEX;
+    stats->n_edges = g->n_edges;
+    stats->n_slabs = 0;
+    stats->arena_bytes = 0;
+    stats->malloc_bytes = g->n_edges * MALLOC_CHUNK_SIZE(sizeof(edge_t));
 
-    vertex_t *v = &g->vertices[i];
+    for(edge_slab_t *slab = g->edge_slabs; slab != NULL; slab = slab->next)
+    {
+        stats->n_slabs++;
+        stats->arena_bytes += MALLOC_CHUNK_SIZE(sizeof(edge_slab_t) + slab->capacity * sizeof(edge_t));
+    }
 
-    /* Free previous label, if one exists */
-    if(v->label != NULL)
-        free(v->label);
+    stats->n_indexes = 0;
+    stats->index_bytes = 0;
 
-    if(label == NULL)
+    for(unsigned int i = 0; i < g->n_vertices; i++)
     {
-        v->label = NULL;
+        edge_index_t *index = g->vertices[i].index;
+
+        if(index != NULL)
+        {
+            stats->n_indexes++;
+            stats->index_bytes += MALLOC_CHUNK_SIZE(sizeof(edge_index_t) + index->size * sizeof(edge_t*));
+        }
     }
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: loads a graph from a text file, for graph_from_file
+ *
+ * Parameters:
+ *  - g, filename: See graph_from_file
+ *
+ * Returns:
+ *  - See graph_from_file
+ */
+static int graph_read_file(graph_t *g, const char *filename)
+{
+    FILE *fp;
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    struct stat st;
+    long pos;
+    unsigned int n_vertices, n_edges;
+    bool undirected;
+    int rc;
+
+    fp = fopen(filename, "r");
+
+    if(fp == NULL)
+        return EFILE;
+
+    /* Directed or undirected graph? */
+    read = getline(&line, &len, fp);
+    if(read == -1)
+        return EPARSE;
+    line[read - 1] = '\0'; // Strip newline
+
+    if(strncmp(line, "undirected", 10) == 0)
+        undirected = true;
+    else if (strncmp(line, "directed", 8) == 0)
+        undirected = false;
+    else
+        return EPARSE;
+
+    /* Read number of vertices and edges */
+    read = getline(&line, &len, fp);
+    if(read == -1)
+        return EPARSE;
+
+    read = sscanf(line, "%i %i", &n_vertices, &n_edges);
+    if(read != 2)
+        return EPARSE;
+    if(n_vertices == 0)
+        return EPARSE;
+
+    rc = graph_init(g, n_vertices);
+    if(rc == ENOMEM)
+        return ENOMEM;
+    if(rc == EINVAL)
+        return EPARSE;
+
+    /* Allocate all the edges in a single slab */
+    if(fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode) && (pos = ftell(fp)) >= 0)
+        rc = graph_reserve_file_edges(g, n_edges, undirected,
+                                      st.st_size > pos ? (unsigned long) (st.st_size - pos) : 0);
     else
+        rc = graph_reserve_file_edges(g, n_edges, undirected, EDGE_SLAB_MAX * MIN_EDGE_LINE_LEN);
+    if(rc != SUCCESS)
+        return rc;
+
+    /* Read vertex labels */
+    for(unsigned int i = 0; i < n_vertices; i++)
     {
-        char *new_label = strndup(label, MAX_LABEL_LEN);
+        read = getline(&line, &len, fp);
+        if(read == -1)
+            return EPARSE;
 
-        if(new_label == NULL)
-            return ENOMEM;
+        /* Strip newline if present */
+        if (line[read - 1] == '\n')
+        {
+            line[read - 1] = '\0';
+        }
+
+        rc = graph_set_label(g, i, line);
+    }
+
+    /* Read edges */
+    for(unsigned int i = 0; i < n_edges; i++)
+    {
+        char label1[MAX_LABEL_LEN + 1], label2[MAX_LABEL_LEN + 1];
+        double weight;
+
+        read = getline(&line, &len, fp);
+        if(read == -1)
+            return EPARSE;
+
+        read = sscanf(line, "%100s %100s %lf", label1, label2, &weight);
+        if(read != 3)
+            return EPARSE;
 
-        v->label = new_label;
+        rc = graph_add_edge_lbl(g, label1, label2, weight);
+        if(rc == ENOTFOUND)
+            return EPARSE;
+
+        if(undirected)
+        {
+            rc = graph_add_edge_lbl(g, label2, label1, weight);
+            if(rc == ENOTFOUND)
+                return EPARSE;
+        }
     }
 
+    free(line);
+    fclose(fp);
+
     return SUCCESS;
 }
 
-/* See graph.h */
-int graph_get_vertex(graph_t *g, unsigned int i, vertex_t **v)
+
+/* See graph.h */
+int graph_from_file(graph_t *g, const char *filename)
+{
+    int rc;
+
+    STATS_BEGIN();
+
+    rc = graph_read_file(g, filename);
+    if(rc == SUCCESS)
+    {
+        STATS_VERTICES(g->n_vertices);
+        STATS_EDGES(g->n_edges);
+    }
+
+    STATS_END();
+
+    return rc;
+}
+
+
+/* MEMORY-MAPPED LOADER
+ *
+ * graph_from_file_mmap maps the whole file into memory and parses it
+ * in place: labels are looked up and copied straight from the mapping,
+ * and weights are parsed by a hand-written parser instead of sscanf.
+ */
+
+/* Exact powers of ten that can be represented by a double */
+static const double pow10_table[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+/* Helper function: whitespace, other than newlines */
+static bool is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+
+/*
+ * Helper function: returns the next line in a buffer
+ *
+ * Parameters:
+ *  - p: Pointer to the current position in the buffer. It is
+ *       advanced to the start of the following line.
+ *  - end: End of the buffer
+ *  - line: Out parameter for the start of the line
+ *  - len: Out parameter for the length of the line (without
+ *         the newline character)
+ *
+ * Returns:
+ *  - true if there was a line to return, false at the end of the buffer
+ */
+static bool next_line(const char **p, const char *end, const char **line, size_t *len)
 {
-    /* Get vertex */
-    if(i >= g->n_vertices)
-        return EINDEX;
+    const char *nl;
 
-    *v = &g->vertices[i];
+    if(*p >= end)
+        return false;
 
-    return SUCCESS;
-}
+    nl = memchr(*p, '\n', end - *p);
+    if(nl == NULL)
+        nl = end;
 
-/* See graph.h */
-long int graph_vertex_index(graph_t *g, vertex_t *v)
-{
-    long int i = (v) - (g)->vertices;
+    *line = *p;
+    *len = nl - *p;
+    *p = nl < end ? nl + 1 : end;
 
-    if(i < 0 || i >= g->n_vertices)
-        return ENOTFOUND;
-    else
-        return i;
+    return true;
 }
 
-/* See graph.h */
-int graph_add_edge(graph_t *g, unsigned int from, unsigned int to, double weight)
-{
-    /* Get vertices */
-    if(from >= g->n_vertices || to >= g->n_vertices)
-        return EINDEX;
 
-    vertex_t *from_v = &g->vertices[from];
-    vertex_t *to_v = &g->vertices[to];
+/*
+ * Helper function: returns the next whitespace-separated token in a line
+ *
+ * Parameters:
+ *  - p: Pointer to the current position in the line. It is
+ *       advanced to the end of the token.
+ *  - end: End of the line
+ *  - token: Out parameter for the start of the token
+ *  - len: Out parameter for the length of the token
+ *
+ * Returns:
+ *  - true if there was a token to return, false otherwise
+ */
+static bool next_token(const char **p, const char *end, const char **token, size_t *len)
+{
+    const char *q = *p;
 
-    /* Create edge */
-    edge_t *e = calloc(1, sizeof(edge_t));
+    while(q < end && is_blank(*q))
+        q++;
 
-    if(e == NULL)
-        return ENOMEM;
+    if(q == end)
+        return false;
 
-    e->to = to_v;
-    e->weight = weight;
+    *token = q;
+    while(q < end && !is_blank(*q))
+        q++;
 
-    /* Add to edge list */
-    e->next = from_v->edges;
-    from_v->edges = e;
+    *len = q - *token;
+    *p = q;
 
-    return SUCCESS;
+    return true;
 }
 
 
 /*
- * Helper function: retrieves an edge
+ * Helper function: parses an unsigned decimal integer
  *
  * Parameters:
- *  - g: The graph
- *  - from, to: The numerical indices of the vertices
- *  - edge: Output parameter
+ *  - token, len: The token to parse
+ *  - n: Out parameter for the integer
  *
  * Returns:
- *  - 0: If the vertices exist. If so, 'edge' is set to NULL
- *    if there is no edge connecting them; otherwise, it will
- *    point to the edge_t struct for that edge.
- *  - EINDEX: If one of the provided indices is invalid
+ *  - true if the token is a valid integer, false otherwise
  */
-static int graph_get_edge(graph_t *g, unsigned int from, unsigned int to, edge_t **e)
+static bool parse_uint(const char *token, size_t len, unsigned int *n)
 {
-    /* Get vertices */
-    if(from >= g->n_vertices || to >= g->n_vertices)
-        return EINDEX;
+    unsigned long value = 0;
 
-    vertex_t *from_v = &g->vertices[from];
-    vertex_t *to_v = &g->vertices[to];
+    if(len == 0)
+        return false;
 
-    /* Iterate over list of edges */
-    *e = from_v->edges;
-    while(*e != NULL)
+    for(size_t i = 0; i < len; i++)
     {
-        if((*e)->to == to_v)
-            break;
+        if(token[i] < '0' || token[i] > '9')
+            return false;
 
-        *e = (*e)->next;
+        value = value * 10 + (token[i] - '0');
+        if(value > 0xFFFFFFFFul)
+            return false;
     }
 
-    return SUCCESS;
+    *n = value;
+
+    return true;
 }
 
 
-/* See graph.h */
-int graph_is_vertex_adjacent(graph_t *g, unsigned int from, unsigned int to, double *weight)
+/*
+ * Helper function: parses a floating-point number
+ *
+ * Plain decimal numbers with up to 19 significant digits and small
+ * exponents are converted exactly with a single multiplication or
+ * division. Anything else (more digits, large exponents, hexadecimal,
+ * infinities, etc.) is handed over to strtod, so the result is always
+ * the same one sscanf("%lf") would produce.
+ *
+ * Parameters:
+ *  - token, len: The token to parse
+ *  - x: Out parameter for the number
+ *
+ * Returns:
+ *  - true if the token starts with a valid number, false otherwise
+ */
+static bool parse_double(const char *token, size_t len, double *x)
 {
-    int rc;
-    edge_t *e;
-
-    rc = graph_get_edge(g, from, to, &e);
-    if(rc == EINDEX)
-        return EINDEX;
+    const char *p = token, *end = token + len;
+    unsigned long long mantissa = 0;
+    int n_digits = 0, exponent = 0;
+    bool negative = false, has_digits = false, inexact = false;
 
-    if(e == NULL)
+    if(p < end && (*p == '+' || *p == '-'))
     {
-        return 0;
+        negative = (*p == '-');
+        p++;
     }
-    else
-    {
-        if(weight != NULL)
-            *weight = e->weight;
 
-        return 1;
+    /* Integer part */
+    for(; p < end && *p >= '0' && *p <= '9'; p++)
+    {
+        has_digits = true;
+        if(n_digits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            if(mantissa != 0)
+                n_digits++;
+        }
+        else
+        {
+            exponent++;
+            inexact |= (*p != '0');
+        }
     }
-}
-
-
-/* See graph.h */
-int graph_num_vertex_with_loops(graph_t *g)
-{
-    int n_with_loops = 0;
 
-    for(unsigned int i=0; i < g->n_vertices; i++)
+    /* Fractional part */
+    if(p < end && *p == '.')
     {
-        edge_t *e = g->vertices[i].edges;
-        while(e != NULL)
+        for(p++; p < end && *p >= '0' && *p <= '9'; p++)
         {
-            if(e->to == &g->vertices[i])
+            has_digits = true;
+            if(n_digits < 19)
             {
-                n_with_loops++;
-                break;
+                mantissa = mantissa * 10 + (*p - '0');
+                if(mantissa != 0)
+                    n_digits++;
+                exponent--;
+            }
+            else
+            {
+                inexact |= (*p != '0');
             }
+        }
+    }
 
-            e = e->next;
+    /* Exponent (only if it has at least one digit) */
+    if(has_digits && p + 1 < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        bool exp_negative = false;
+        int exp_value = 0;
+
+        if(*q == '+' || *q == '-')
+        {
+            exp_negative = (*q == '-');
+            q++;
+        }
+
+        if(q < end && *q >= '0' && *q <= '9')
+        {
+            for(; q < end && *q >= '0' && *q <= '9'; q++)
+                if(exp_value < 10000)
+                    exp_value = exp_value * 10 + (*q - '0');
+
+            exponent += exp_negative ? -exp_value : exp_value;
+            p = q;
         }
     }
 
-    return n_with_loops;
+    /* Fast path: the mantissa and the power of ten are both exactly
+     * representable, so one operation gives a correctly rounded result */
+    if(has_digits && p == end && !inexact && mantissa <= (1ull << 53) &&
+       exponent >= -22 && exponent <= 22)
+    {
+        double value = (double) mantissa;
+
+        if(exponent < 0)
+            value /= pow10_table[-exponent];
+        else
+            value *= pow10_table[exponent];
+
+        *x = negative ? -value : value;
+
+        return true;
+    }
+
+    /* Slow path */
+    char buf[128];
+    char *copy = len < sizeof(buf) ? buf : malloc(len + 1);
+    char *copy_end;
+
+    if(copy == NULL)
+        return false;
+
+    memcpy(copy, token, len);
+    copy[len] = '\0';
+    *x = strtod(copy, &copy_end);
+
+    bool valid = (copy_end != copy);
+    if(copy != buf)
+        free(copy);
+
+    return valid;
 }
 
 
-/* See graph.h */
-int graph_from_file(graph_t *g, const char *filename)
+/*
+ * Helper function: parses a graph in the text format read by
+ * graph_from_file
+ *
+ * Parameters:
+ *  - g: The graph to initialize. Must point to allocated memory.
+ *  - p: The text
+ *  - end: End of the text
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ *  - EPARSE: If the text could not be parsed. If the graph had
+ *    already been initialized, it is freed.
+ */
+static int graph_parse_text(graph_t *g, const char *p, const char *end)
 {
-    FILE *fp;
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t read;
+    const char *line, *token, *q;
+    size_t len, token_len;
     unsigned int n_vertices, n_edges;
     bool undirected;
     int rc;
 
-    fp = fopen(filename, "r");
-
-    if(fp == NULL)
-        return EFILE;
-
     /* Directed or undirected graph? */
-    read = getline(&line, &len, fp);
-    if(read == -1)
+    if(!next_line(&p, end, &line, &len))
         return EPARSE;
-    line[read - 1] = '\0'; // Strip newline
 
-    if(strncmp(line, "undirected", 10) == 0)
+    if(len >= 10 && strncmp(line, "undirected", 10) == 0)
         undirected = true;
-    else if (strncmp(line, "directed", 8) == 0)
+    else if(len >= 8 && strncmp(line, "directed", 8) == 0)
         undirected = false;
     else
         return EPARSE;
 
     /* Read number of vertices and edges */
-    read = getline(&line, &len, fp);
-    if(read == -1)
+    if(!next_line(&p, end, &line, &len))
         return EPARSE;
 
-    read = sscanf(line, "%i %i", &n_vertices, &n_edges);
-    if(read != 2)
+    q = line;
+    if(!next_token(&q, line + len, &token, &token_len) ||
+       !parse_uint(token, token_len, &n_vertices))
+        return EPARSE;
+    if(!next_token(&q, line + len, &token, &token_len) ||
+       !parse_uint(token, token_len, &n_edges))
         return EPARSE;
     if(n_vertices == 0)
         return EPARSE;
 
     rc = graph_init(g, n_vertices);
-    if(rc == ENOMEM)
-        return ENOMEM;
-    if(rc == EINVAL)
-        return EPARSE;
+    if(rc != SUCCESS)
+        return rc;
+
+    rc = graph_reserve_file_edges(g, n_edges, undirected, (unsigned long) (end - p));
+    if(rc != SUCCESS)
+        goto error;
 
     /* Read vertex labels */
     for(unsigned int i = 0; i < n_vertices; i++)
     {
-        read = getline(&line, &len, fp);
-        if(read == -1)
-            return EPARSE;
-
-        /* Strip newline if present */
-        if (line[read - 1] == '\n')
+        if(!next_line(&p, end, &line, &len))
         {
-            line[read - 1] = '\0';
+            rc = EPARSE;
+            goto error;
         }
 
-        rc = graph_set_label(g, i, line);
+        rc = graph_set_label_n(g, i, line, len);
+        if(rc != SUCCESS)
+            goto error;
     }
 
     /* Read edges */
     for(unsigned int i = 0; i < n_edges; i++)
     {
-        char label1[MAX_LABEL_LEN + 1], label2[MAX_LABEL_LEN + 1];
+        const char *label1, *label2;
+        size_t len1, len2;
+        int from, to;
         double weight;
 
-        read = getline(&line, &len, fp);
-        if(read == -1)
-            return EPARSE;
+        if(!next_line(&p, end, &line, &len))
+        {
+            rc = EPARSE;
+            goto error;
+        }
 
-        read = sscanf(line, "%100s %100s %lf", label1, label2, &weight);
-        if(read != 3)
-            return EPARSE;
+        q = line;
+        if(!next_token(&q, line + len, &label1, &len1) ||
+           !next_token(&q, line + len, &label2, &len2) ||
+           !next_token(&q, line + len, &token, &token_len) ||
+           !parse_double(token, token_len, &weight))
+        {
+            rc = EPARSE;
+            goto error;
+        }
 
-        rc = graph_add_edge_lbl(g, label1, label2, weight);
-        if(rc == ENOTFOUND)
-            return EPARSE;
+        from = label_map_find(g, label1, len1 < MAX_LABEL_LEN ? len1 : MAX_LABEL_LEN);
+        to = label_map_find(g, label2, len2 < MAX_LABEL_LEN ? len2 : MAX_LABEL_LEN);
+        if(from == ENOTFOUND || to == ENOTFOUND)
+        {
+            rc = EPARSE;
+            goto error;
+        }
 
-        if(undirected)
+        rc = graph_add_edge(g, from, to, weight);
+        if(rc == SUCCESS && undirected)
+            rc = graph_add_edge(g, to, from, weight);
+        if(rc != SUCCESS)
+            goto error;
+    }
+
+    return SUCCESS;
+
+error:
+    graph_free(g);
+    return rc;
+}
+
+
+/* See graph.h */
+int graph_from_file_mmap(graph_t *g, const char *filename)
+{
+    struct stat st;
+    char *data;
+    int fd, rc;
+
+    fd = open(filename, O_RDONLY);
+    if(fd == -1)
+        return EFILE;
+
+    if(fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return EFILE;
+    }
+
+    /* An empty file can't be mapped (and isn't a valid graph) */
+    if(st.st_size == 0)
+    {
+        close(fd);
+        return EPARSE;
+    }
+
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+        return EFILE;
+
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    STATS_BEGIN();
+
+    rc = graph_parse_text(g, data, data + st.st_size);
+    if(rc == SUCCESS)
+    {
+        STATS_VERTICES(g->n_vertices);
+        STATS_EDGES(g->n_edges);
+    }
+
+    STATS_END();
+
+    munmap(data, st.st_size);
+
+    return rc;
+}
+
+
+/* See graph.h */
+int graph_to_file(graph_t *g, const char *filename)
+{
+    FILE *f;
+    int rc;
+
+    f = fopen(filename, "w");
+    if(f == NULL)
+        return EFILE;
+
+    fprintf(f, "directed\n%u %lu\n", g->n_vertices, g->n_edges);
+
+    for(unsigned int i = 0; i < g->n_vertices; i++)
+    {
+        if(g->vertices[i].label != NULL)
+            fprintf(f, "%s\n", g->vertices[i].label);
+        else
+            fprintf(f, "%u\n", i);
+    }
+
+    for(unsigned int i = 0; i < g->n_vertices; i++)
+    {
+        char *from = g->vertices[i].label;
+
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
         {
-            rc = graph_add_edge_lbl(g, label2, label1, weight);
-            if(rc == ENOTFOUND)
-                return EPARSE;
+            char *to = e->to->label;
+
+            if(from != NULL)
+                fprintf(f, "%s ", from);
+            else
+                fprintf(f, "%u ", i);
+
+            if(to != NULL)
+                fprintf(f, "%s", to);
+            else
+                fprintf(f, "%li", graph_vertex_index(g, e->to));
+
+            /* %.17g is enough to read back the exact same weight */
+            fprintf(f, " %.17g\n", e->weight);
         }
     }
 
+    rc = ferror(f);
+    if(fclose(f) != 0 || rc != 0)
+        return EFILE;
+
     return SUCCESS;
 }
 
@@ -401,13 +2051,10 @@ int graph_to_dot(graph_t *g, const char *filename, bool undirected, bool weights
  */
 static int graph_label_to_index(graph_t *g, const char *label)
 {
-    for(unsigned int i=0; i < g->n_vertices; i++)
-    {
-        if(strncmp(g->vertices[i].label, label, MAX_LABEL_LEN) == 0)
-            return i;
-    }
+    if(label == NULL)
+        return ENOTFOUND;
 
-    return ENOTFOUND;
+    return label_map_find(g, label, strnlen(label, MAX_LABEL_LEN));
 }
 
 
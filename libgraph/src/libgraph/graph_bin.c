@@ -0,0 +1,435 @@
+#include "graph.h"
+#include "csr.h"
+#include "counters.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* BINARY FORMAT
+ *
+ * A binary graph file contains the following sections, each of them
+ * starting at an offset that is a multiple of 8 bytes:
+ *
+ *  - A header (bin_header_t)
+ *  - Edge offsets: n_vertices + 1 uint64_t values, as in graph_csr_t
+ *  - Label offsets: n_vertices uint64_t values, with the position of
+ *    each vertex's label in the label pool (or BIN_NO_LABEL)
+ *  - Edge weights: n_edges doubles
+ *  - Edge targets: n_edges uint32_t values
+ *  - Label pool: pool_size bytes, containing NUL-terminated labels
+ *
+ * The edges of each vertex are stored in the same order as they appear
+ * in its list of edges.
+ */
+
+/* Identifies binary graph files */
+#define BIN_MAGIC "LIBGRAPH"
+#define BIN_MAGIC_LEN (8)
+
+/* Version of the binary format */
+#define BIN_VERSION (1)
+
+/* Written in the byte order of the machine that wrote the file, so files
+ * written by a machine with a different byte order can be rejected */
+#define BIN_BYTE_ORDER (0x01020304u)
+
+/* Label offset of a vertex without a label */
+#define BIN_NO_LABEL (~(uint64_t) 0)
+
+/* Rounds n up to a multiple of 8 */
+#define ALIGN8(n) (((n) + 7) & ~((uint64_t) 7))
+
+
+/* Header of a binary graph file */
+typedef struct bin_header {
+    char magic[BIN_MAGIC_LEN];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t n_vertices;
+    uint64_t n_edges;
+    uint64_t pool_size;
+} bin_header_t;
+
+
+/* Position of each section in a binary graph file */
+typedef struct bin_layout {
+    uint64_t offsets;
+    uint64_t labels;
+    uint64_t weights;
+    uint64_t targets;
+    uint64_t pool;
+    uint64_t size;
+} bin_layout_t;
+
+
+/* A binary graph file mapped in memory */
+typedef struct bin_file {
+    char *map;
+    size_t map_len;
+    const bin_header_t *header;
+    const uint64_t *offsets;
+    const uint64_t *labels;
+    const double *weights;
+    const uint32_t *targets;
+    const char *pool;
+} bin_file_t;
+
+
+/*
+ * Helper function: computes the position of each section of a file
+ *
+ * Parameters:
+ *  - h: The header of the file
+ *  - layout: Out parameter for the layout
+ *
+ * Returns:
+ *  - Always returns 0
+ */
+static int bin_layout(const bin_header_t *h, bin_layout_t *layout)
+{
+    layout->offsets = ALIGN8(sizeof(bin_header_t));
+    layout->labels = layout->offsets + (h->n_vertices + 1) * sizeof(uint64_t);
+    layout->weights = layout->labels + h->n_vertices * sizeof(uint64_t);
+    layout->targets = layout->weights + h->n_edges * sizeof(double);
+    layout->pool = ALIGN8(layout->targets + h->n_edges * sizeof(uint32_t));
+    layout->size = layout->pool + h->pool_size;
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: maps a binary graph file into memory, and checks
+ * that its header and edge offsets are valid
+ *
+ * Parameters:
+ *  - filename: The file
+ *  - f: Out parameter for the mapped file
+ *
+ * Returns:
+ *  - 0 on success
+ *  - EFILE: Error when opening/reading the file
+ *  - EPARSE: If the file is not a valid binary graph file
+ */
+static int bin_map(const char *filename, bin_file_t *f)
+{
+    struct stat st;
+    bin_layout_t layout;
+    const bin_header_t *h;
+    int fd;
+
+    fd = open(filename, O_RDONLY);
+    if(fd == -1)
+        return EFILE;
+
+    if(fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return EFILE;
+    }
+
+    if((size_t) st.st_size < sizeof(bin_header_t))
+    {
+        close(fd);
+        return EPARSE;
+    }
+
+    f->map_len = st.st_size;
+    f->map = mmap(NULL, f->map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(f->map == MAP_FAILED)
+        return EFILE;
+
+    h = (const bin_header_t *) f->map;
+    if(memcmp(h->magic, BIN_MAGIC, BIN_MAGIC_LEN) != 0 ||
+       h->version != BIN_VERSION || h->byte_order != BIN_BYTE_ORDER ||
+       h->n_vertices == 0 || h->n_vertices > 0xFFFFFFFFu ||
+       h->n_edges > f->map_len || h->pool_size > f->map_len)
+    {
+        munmap(f->map, f->map_len);
+        return EPARSE;
+    }
+
+    bin_layout(h, &layout);
+    if(layout.size != f->map_len)
+    {
+        munmap(f->map, f->map_len);
+        return EPARSE;
+    }
+
+    f->header = h;
+    f->offsets = (const uint64_t *) (f->map + layout.offsets);
+    f->labels = (const uint64_t *) (f->map + layout.labels);
+    f->weights = (const double *) (f->map + layout.weights);
+    f->targets = (const uint32_t *) (f->map + layout.targets);
+    f->pool = f->map + layout.pool;
+
+    /* Every label must be NUL-terminated */
+    if(h->pool_size > 0 && f->pool[h->pool_size - 1] != '\0')
+    {
+        munmap(f->map, f->map_len);
+        return EPARSE;
+    }
+
+    /* The edge offsets must be increasing, and cover every edge */
+    if(f->offsets[0] != 0 || f->offsets[h->n_vertices] != h->n_edges)
+    {
+        munmap(f->map, f->map_len);
+        return EPARSE;
+    }
+
+    for(uint64_t i = 0; i < h->n_vertices; i++)
+    {
+        if(f->offsets[i] > f->offsets[i + 1] ||
+           (f->labels[i] != BIN_NO_LABEL && f->labels[i] >= h->pool_size))
+        {
+            munmap(f->map, f->map_len);
+            return EPARSE;
+        }
+    }
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: writes zero bytes to a file
+ *
+ * Parameters:
+ *  - f: The file
+ *  - n: Number of bytes (less than 8)
+ *
+ * Returns:
+ *  - true on success, false if the bytes could not be written
+ */
+static bool write_padding(FILE *f, size_t n)
+{
+    static const char padding[8] = { 0 };
+
+    return n == 0 || fwrite(padding, n, 1, f) == 1;
+}
+
+
+/* See graph.h */
+int graph_to_bin(graph_t *g, const char *filename)
+{
+    bin_header_t h;
+    bin_layout_t layout;
+    graph_csr_t csr;
+    uint64_t *offsets, *labels;
+    FILE *f;
+    int rc;
+
+    rc = graph_freeze(g, &csr);
+    if(rc != SUCCESS)
+        return rc;
+
+    offsets = malloc((csr.n_vertices + 1) * sizeof(uint64_t));
+    labels = malloc(csr.n_vertices * sizeof(uint64_t));
+    if(offsets == NULL || labels == NULL)
+    {
+        free(offsets);
+        free(labels);
+        graph_csr_free(&csr);
+        return ENOMEM;
+    }
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BIN_MAGIC, BIN_MAGIC_LEN);
+    h.version = BIN_VERSION;
+    h.byte_order = BIN_BYTE_ORDER;
+    h.n_vertices = csr.n_vertices;
+    h.n_edges = csr.n_edges;
+    h.pool_size = 0;
+
+    for(unsigned int i = 0; i < csr.n_vertices; i++)
+    {
+        offsets[i] = csr.offsets[i];
+
+        if(csr.labels[i] == NULL)
+        {
+            labels[i] = BIN_NO_LABEL;
+        }
+        else
+        {
+            labels[i] = h.pool_size;
+            h.pool_size += strlen(csr.labels[i]) + 1;
+        }
+    }
+    offsets[csr.n_vertices] = csr.n_edges;
+
+    bin_layout(&h, &layout);
+
+    f = fopen(filename, "w");
+    if(f == NULL)
+    {
+        rc = EFILE;
+    }
+    else
+    {
+        bool ok = true;
+
+        ok = ok && fwrite(&h, sizeof(h), 1, f) == 1;
+        ok = ok && write_padding(f, layout.offsets - sizeof(h));
+        ok = ok && fwrite(offsets, sizeof(uint64_t), csr.n_vertices + 1, f) == csr.n_vertices + 1;
+        ok = ok && fwrite(labels, sizeof(uint64_t), csr.n_vertices, f) == csr.n_vertices;
+        ok = ok && fwrite(csr.weights, sizeof(double), csr.n_edges, f) == csr.n_edges;
+
+        /* graph_freeze stores targets as unsigned int, which
+         * only needs converting if it is not 32 bits wide */
+        if(sizeof(unsigned int) == sizeof(uint32_t))
+        {
+            ok = ok && fwrite(csr.targets, sizeof(uint32_t), csr.n_edges, f) == csr.n_edges;
+        }
+        else
+        {
+            for(unsigned long e = 0; ok && e < csr.n_edges; e++)
+            {
+                uint32_t target = csr.targets[e];
+                ok = fwrite(&target, sizeof(target), 1, f) == 1;
+            }
+        }
+
+        ok = ok && write_padding(f, layout.pool - (layout.targets + csr.n_edges * sizeof(uint32_t)));
+
+        for(unsigned int i = 0; ok && i < csr.n_vertices; i++)
+            if(csr.labels[i] != NULL)
+                ok = fwrite(csr.labels[i], strlen(csr.labels[i]) + 1, 1, f) == 1;
+
+        rc = ok ? SUCCESS : EFILE;
+
+        if(fclose(f) != 0)
+            rc = EFILE;
+    }
+
+    free(offsets);
+    free(labels);
+    graph_csr_free(&csr);
+
+    return rc;
+}
+
+
+/* See graph.h */
+int graph_from_bin(graph_t *g, const char *filename)
+{
+    bin_file_t f;
+    unsigned int n;
+    int rc;
+
+    rc = bin_map(filename, &f);
+    if(rc != SUCCESS)
+        return rc;
+
+    STATS_BEGIN();
+
+    n = f.header->n_vertices;
+
+    rc = graph_init(g, n);
+    if(rc != SUCCESS)
+    {
+        munmap(f.map, f.map_len);
+        STATS_END();
+        return rc;
+    }
+
+    rc = graph_reserve_edges(g, f.header->n_edges);
+
+    for(unsigned int i = 0; rc == SUCCESS && i < n; i++)
+        if(f.labels[i] != BIN_NO_LABEL)
+            rc = graph_set_label(g, i, f.pool + f.labels[i]);
+
+    /* Edges are added to the head of the list, so we add each
+     * vertex's edges in reverse order to preserve their order */
+    for(unsigned int i = 0; rc == SUCCESS && i < n; i++)
+    {
+        for(uint64_t e = f.offsets[i + 1]; rc == SUCCESS && e > f.offsets[i]; e--)
+        {
+            if(f.targets[e - 1] >= n)
+                rc = EPARSE;
+            else
+                rc = graph_add_edge(g, i, f.targets[e - 1], f.weights[e - 1]);
+        }
+    }
+
+    munmap(f.map, f.map_len);
+
+    if(rc != SUCCESS)
+        graph_free(g);
+    else
+    {
+        STATS_VERTICES(n);
+        STATS_EDGES(g->n_edges);
+    }
+
+    STATS_END();
+
+    return rc;
+}
+
+
+/* See csr.h */
+int graph_csr_from_bin(graph_csr_t *csr, const char *filename)
+{
+    bin_file_t f;
+    int rc;
+
+    /* The offsets in the file can only be used as the snapshot's
+     * offsets if unsigned long is 64 bits wide */
+    if(sizeof(unsigned long) != sizeof(uint64_t) || sizeof(unsigned int) != sizeof(uint32_t))
+        return EPARSE;
+
+    rc = bin_map(filename, &f);
+    if(rc != SUCCESS)
+        return rc;
+
+    csr->n_vertices = f.header->n_vertices;
+    csr->n_edges = f.header->n_edges;
+    csr->offsets = (unsigned long *) f.offsets;
+    csr->targets = (unsigned int *) f.targets;
+    csr->weights = (double *) f.weights;
+    csr->labels = malloc(csr->n_vertices * sizeof(char*));
+    csr->source = NULL;
+    csr->version = 0;
+    csr->transposed = false;
+    csr->map = f.map;
+    csr->map_len = f.map_len;
+
+    if(csr->labels == NULL)
+    {
+        munmap(f.map, f.map_len);
+        return ENOMEM;
+    }
+
+    for(unsigned int i = 0; i < csr->n_vertices; i++)
+        csr->labels[i] = f.labels[i] == BIN_NO_LABEL ? NULL : (char *) f.pool + f.labels[i];
+
+    return SUCCESS;
+}
+
+
+/* See graph.h */
+int graph_load(graph_t *g, const char *filename)
+{
+    char magic[BIN_MAGIC_LEN];
+    size_t read;
+    FILE *fp;
+
+    fp = fopen(filename, "r");
+    if(fp == NULL)
+        return EFILE;
+
+    read = fread(magic, 1, BIN_MAGIC_LEN, fp);
+    fclose(fp);
+
+    if(read == BIN_MAGIC_LEN && memcmp(magic, BIN_MAGIC, BIN_MAGIC_LEN) == 0)
+        return graph_from_bin(g, filename);
+    else
+        return graph_from_file_mmap(g, filename);
+}
@@ -0,0 +1,165 @@
+#include "heap.h"
+#include <stdlib.h>
+
+
+/* See heap.h */
+int iheap_init(iheap_t *h, unsigned int capacity, unsigned int d)
+{
+    h->d = (d >= 2) ? d : IHEAP_DEFAULT_ARITY;
+    h->size = 0;
+    h->capacity = capacity;
+    h->entries = malloc(capacity * sizeof(iheap_entry_t));
+    h->pos = malloc(capacity * sizeof(unsigned int));
+
+    if(h->entries == NULL || h->pos == NULL)
+    {
+        free(h->entries);
+        free(h->pos);
+        return ENOMEM;
+    }
+
+    for(unsigned int i = 0; i < capacity; i++)
+        h->pos[i] = IHEAP_NOT_IN_HEAP;
+
+    return SUCCESS;
+}
+
+
+/* See heap.h */
+int iheap_free(iheap_t *h)
+{
+    free(h->entries);
+    free(h->pos);
+
+    return SUCCESS;
+}
+
+
+/* See heap.h */
+int iheap_clear(iheap_t *h)
+{
+    for(unsigned int i = 0; i < h->size; i++)
+        h->pos[h->entries[i].id] = IHEAP_NOT_IN_HEAP;
+
+    h->size = 0;
+
+    return SUCCESS;
+}
+
+
+/* See heap.h */
+bool iheap_contains(iheap_t *h, unsigned int id)
+{
+    return id < h->capacity && h->pos[id] != IHEAP_NOT_IN_HEAP;
+}
+
+
+/*
+ * Helper function: moves an entry up the heap until its parent
+ * has a smaller key
+ *
+ * Parameters:
+ *  - h: The heap
+ *  - i: Position of the entry
+ *  - entry: The entry (which is placed in its final position)
+ */
+static void iheap_sift_up(iheap_t *h, unsigned int i, iheap_entry_t entry)
+{
+    while(i > 0)
+    {
+        unsigned int parent = (i - 1) / h->d;
+
+        if(h->entries[parent].key <= entry.key)
+            break;
+
+        h->entries[i] = h->entries[parent];
+        h->pos[h->entries[i].id] = i;
+        i = parent;
+    }
+
+    h->entries[i] = entry;
+    h->pos[entry.id] = i;
+}
+
+
+/*
+ * Helper function: moves an entry down the heap until all
+ * its children have larger keys
+ *
+ * Parameters:
+ *  - h: The heap
+ *  - i: Position of the entry
+ *  - entry: The entry (which is placed in its final position)
+ */
+static void iheap_sift_down(iheap_t *h, unsigned int i, iheap_entry_t entry)
+{
+    while(true)
+    {
+        unsigned long first = (unsigned long) i * h->d + 1;
+        unsigned long last = first + h->d;
+        unsigned int best = i;
+        double best_key = entry.key;
+
+        if(first >= h->size)
+            break;
+        if(last > h->size)
+            last = h->size;
+
+        for(unsigned long c = first; c < last; c++)
+        {
+            if(h->entries[c].key < best_key)
+            {
+                best = c;
+                best_key = h->entries[c].key;
+            }
+        }
+
+        if(best == i)
+            break;
+
+        h->entries[i] = h->entries[best];
+        h->pos[h->entries[i].id] = i;
+        i = best;
+    }
+
+    h->entries[i] = entry;
+    h->pos[entry.id] = i;
+}
+
+
+/* See heap.h */
+int iheap_push(iheap_t *h, unsigned int id, double key)
+{
+    iheap_entry_t entry = { key, id };
+
+    if(id >= h->capacity)
+        return EINDEX;
+
+    if(h->pos[id] == IHEAP_NOT_IN_HEAP)
+        iheap_sift_up(h, h->size++, entry);
+    else if(key < h->entries[h->pos[id]].key)
+        iheap_sift_up(h, h->pos[id], entry);
+
+    return SUCCESS;
+}
+
+
+/* See heap.h */
+int iheap_pop(iheap_t *h, unsigned int *id, double *key)
+{
+    if(h->size == 0)
+        return EEMPTY;
+
+    *id = h->entries[0].id;
+    if(key != NULL)
+        *key = h->entries[0].key;
+
+    h->pos[*id] = IHEAP_NOT_IN_HEAP;
+    h->size--;
+
+    /* Move the last entry to the root, and restore the heap property */
+    if(h->size > 0)
+        iheap_sift_down(h, 0, h->entries[h->size]);
+
+    return SUCCESS;
+}
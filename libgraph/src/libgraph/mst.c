@@ -0,0 +1,298 @@
+#include "algorithms.h"
+#include "dset.h"
+#include "heap.h"
+#include "parallel.h"
+#include <stdlib.h>
+
+
+/* An edge, as sorted by Kruskal's algorithm */
+typedef struct mst_edge {
+    double weight;
+    unsigned int from;
+    unsigned int to;
+} mst_edge_t;
+
+
+/* Orders edges by weight, breaking ties by their endpoints,
+ * so the tree does not depend on how the sort is done */
+static int mst_edge_cmp(const void *p1, const void *p2)
+{
+    const mst_edge_t *e1 = p1, *e2 = p2;
+
+    if(e1->weight != e2->weight)
+        return e1->weight < e2->weight ? -1 : 1;
+    if(e1->from != e2->from)
+        return e1->from < e2->from ? -1 : 1;
+    if(e1->to != e2->to)
+        return e1->to < e2->to ? -1 : 1;
+
+    return 0;
+}
+
+
+/*
+ * Helper function: creates the graph that will hold a spanning forest,
+ * with the same vertices and labels as a graph but no edges
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - tree: Out parameter for the new graph
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int mst_tree_init(graph_t *g, graph_t **tree)
+{
+    int rc;
+
+    *tree = calloc(1, sizeof(graph_t));
+    if(*tree == NULL)
+        return ENOMEM;
+
+    rc = graph_init(*tree, g->n_vertices);
+
+    for(unsigned int i = 0; i < g->n_vertices && rc == SUCCESS; i++)
+        rc = graph_set_label(*tree, i, g->vertices[i].label);
+
+    /* Vertices removed from g are removed from the forest too,
+     * so both graphs have the same vertex indices */
+    for(unsigned int i = 0; i < g->n_vertices && rc == SUCCESS; i++)
+        (*tree)->vertices[i].removed = g->vertices[i].removed;
+
+    if(rc == SUCCESS)
+        (*tree)->n_removed = g->n_removed;
+
+    /* Every edge of the forest is stored in both directions */
+    if(rc == SUCCESS && g->n_vertices > 1)
+        rc = graph_reserve_edges(*tree, 2 * (unsigned long) (g->n_vertices - 1));
+
+    if(rc != SUCCESS)
+    {
+        graph_free(*tree);
+        free(*tree);
+        *tree = NULL;
+    }
+
+    return rc;
+}
+
+
+/*
+ * Helper function: adds an edge to a spanning forest, in both directions
+ *
+ * Parameters:
+ *  - tree: The forest
+ *  - from, to: The vertices
+ *  - weight: The weight of the edge
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int mst_tree_add(graph_t *tree, unsigned int from, unsigned int to, double weight)
+{
+    int rc = graph_add_edge(tree, from, to, weight);
+
+    if(rc == SUCCESS)
+        rc = graph_add_edge(tree, to, from, weight);
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_mst_kruskal(graph_t *g, unsigned int n_threads, graph_t **tree, double *weight)
+{
+    unsigned int n = g->n_vertices;
+    mst_edge_t *edges;
+    unsigned long n_edges = 0;
+    dset_t d;
+    int rc;
+
+    *tree = NULL;
+    *weight = 0.0;
+
+    edges = malloc((g->n_edges > 0 ? g->n_edges : 1) * sizeof(mst_edge_t));
+    if(edges == NULL)
+        return ENOMEM;
+
+    /* Undirected graphs have every edge twice (once in each direction),
+     * and both copies are kept: the second one is discarded by the
+     * union-find, which is cheaper than looking for it here */
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned int i_next = e->to - g->vertices;
+
+            if(i_next == i)
+                continue;
+
+            edges[n_edges].weight = e->weight;
+            edges[n_edges].from = i < i_next ? i : i_next;
+            edges[n_edges].to = i < i_next ? i_next : i;
+            n_edges++;
+        }
+
+    rc = parallel_sort(edges, n_edges, sizeof(mst_edge_t), mst_edge_cmp, n_threads);
+
+    if(rc == SUCCESS)
+        rc = dset_init(&d, n);
+
+    if(rc != SUCCESS)
+    {
+        free(edges);
+        return rc;
+    }
+
+    rc = mst_tree_init(g, tree);
+
+    /* A spanning forest of a graph with c components has n - c edges,
+     * so we can stop as soon as there is one set left */
+    for(unsigned long k = 0; k < n_edges && d.n_sets > 1 && rc == SUCCESS; k++)
+        if(dset_union(&d, edges[k].from, edges[k].to))
+        {
+            rc = mst_tree_add(*tree, edges[k].from, edges[k].to, edges[k].weight);
+            *weight += edges[k].weight;
+        }
+
+    free(edges);
+    dset_free(&d);
+
+    if(rc != SUCCESS && *tree != NULL)
+    {
+        graph_free(*tree);
+        free(*tree);
+        *tree = NULL;
+    }
+
+    return rc;
+}
+
+
+/*
+ * Helper function: updates the lightest edge between a vertex and the
+ * tree that Prim's algorithm is growing, after following an edge to it
+ *
+ * Parameters:
+ *  - heap: The vertices next to the tree, keyed by best
+ *  - best, from: See graph_mst_prim
+ *  - i: The tree vertex the edge comes from
+ *  - i_next: The vertex it leads to (not in the tree)
+ *  - weight: The weight of the edge
+ */
+static void prim_relax(iheap_t *heap, double *best, unsigned int *from,
+                       unsigned int i, unsigned int i_next, double weight)
+{
+    if(iheap_contains(heap, i_next) && weight >= best[i_next])
+        return;
+
+    best[i_next] = weight;
+    from[i_next] = i;
+    iheap_push(heap, i_next, weight);
+}
+
+
+/* See algorithms.h */
+int graph_mst_prim(graph_t *g, graph_t **tree, double *weight)
+{
+    unsigned int n = g->n_vertices;
+    graph_csr_t in;
+    iheap_t heap;
+    int rc;
+
+    *tree = NULL;
+    *weight = 0.0;
+
+    /* The direction of the edges is ignored, so each vertex needs its
+     * incoming edges as well as its outgoing ones */
+    rc = graph_freeze_transpose(g, &in);
+    if(rc != SUCCESS)
+        return rc;
+
+    /* best[i] is the weight of the lightest edge between vertex i and
+     * the tree, and from[i] the tree vertex at the other end (or
+     * GRAPH_NO_VERTEX once i is part of the tree) */
+    double *best = malloc((n > 0 ? n : 1) * sizeof(double));
+    unsigned int *from = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    bool *done = calloc(n > 0 ? n : 1, sizeof(bool));
+
+    if(best == NULL || from == NULL || done == NULL)
+        rc = ENOMEM;
+
+    if(rc == SUCCESS)
+        rc = iheap_init(&heap, n, IHEAP_DEFAULT_ARITY);
+
+    if(rc == SUCCESS)
+    {
+        rc = mst_tree_init(g, tree);
+        if(rc != SUCCESS)
+            iheap_free(&heap);
+    }
+
+    if(rc != SUCCESS)
+    {
+        free(best);
+        free(from);
+        free(done);
+        graph_csr_free(&in);
+        return rc;
+    }
+
+    for(unsigned int i = 0; i < n; i++)
+        from[i] = GRAPH_NO_VERTEX;
+
+    /* Grow a tree from every vertex that is not in one yet */
+    for(unsigned int s = 0; s < n && rc == SUCCESS; s++)
+    {
+        if(done[s] || g->vertices[s].removed)
+            continue;
+
+        iheap_push(&heap, s, 0.0);
+
+        while(heap.size > 0 && rc == SUCCESS)
+        {
+            unsigned int i;
+
+            iheap_pop(&heap, &i, NULL);
+            done[i] = true;
+
+            if(from[i] != GRAPH_NO_VERTEX)
+            {
+                rc = mst_tree_add(*tree, from[i], i, best[i]);
+                *weight += best[i];
+            }
+
+            for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+            {
+                unsigned int i_next = e->to - g->vertices;
+
+                if(!done[i_next])
+                    prim_relax(&heap, best, from, i, i_next, e->weight);
+            }
+
+            for(unsigned long k = in.offsets[i]; k < in.offsets[i + 1]; k++)
+            {
+                unsigned int i_next = in.targets[k];
+
+                if(!done[i_next])
+                    prim_relax(&heap, best, from, i, i_next, in.weights[k]);
+            }
+        }
+    }
+
+    iheap_free(&heap);
+    free(best);
+    free(from);
+    free(done);
+    graph_csr_free(&in);
+
+    if(rc != SUCCESS)
+    {
+        graph_free(*tree);
+        free(*tree);
+        *tree = NULL;
+    }
+
+    return rc;
+}
@@ -0,0 +1,261 @@
+#include "graph.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+
+/* Threads started by parallel_run wait until every thread has been
+ * created, and then either run the function or give up */
+#define PARALLEL_WAIT  (0)
+#define PARALLEL_GO    (1)
+#define PARALLEL_ABORT (2)
+
+/* State shared by the threads started by a call to parallel_run */
+typedef struct parallel_start {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int state;
+} parallel_start_t;
+
+/* Arguments passed to each thread started by parallel_run */
+typedef struct parallel_thread {
+    pthread_t thread;
+    unsigned int tid;
+    unsigned int n_threads;
+    parallel_fn fn;
+    void *arg;
+    parallel_start_t *start;
+} parallel_thread_t;
+
+
+/* Entry point of the threads started by parallel_run */
+static void *parallel_thread_main(void *p)
+{
+    parallel_thread_t *t = p;
+    int state;
+
+    pthread_mutex_lock(&t->start->lock);
+    while(t->start->state == PARALLEL_WAIT)
+        pthread_cond_wait(&t->start->cond, &t->start->lock);
+    state = t->start->state;
+    pthread_mutex_unlock(&t->start->lock);
+
+    if(state == PARALLEL_GO)
+        t->fn(t->tid, t->n_threads, t->arg);
+
+    return NULL;
+}
+
+
+/* See parallel.h */
+unsigned int parallel_threads(unsigned int requested)
+{
+    long n;
+
+    if(requested > 0)
+        return requested;
+
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return n > 0 ? n : 1;
+}
+
+
+/* See parallel.h */
+int parallel_run(unsigned int n_threads, parallel_fn fn, void *arg)
+{
+    parallel_thread_t *threads;
+    parallel_start_t start;
+    unsigned int started = 1;
+    int rc = SUCCESS;
+
+    if(n_threads <= 1)
+    {
+        fn(0, 1, arg);
+        return SUCCESS;
+    }
+
+    threads = calloc(n_threads, sizeof(parallel_thread_t));
+    if(threads == NULL)
+        return ENOMEM;
+
+    for(unsigned int i = 0; i < n_threads; i++)
+    {
+        threads[i].tid = i;
+        threads[i].n_threads = n_threads;
+        threads[i].fn = fn;
+        threads[i].arg = arg;
+        threads[i].start = &start;
+    }
+
+    pthread_mutex_init(&start.lock, NULL);
+    pthread_cond_init(&start.cond, NULL);
+    start.state = PARALLEL_WAIT;
+
+    /* The function must be run by exactly n_threads threads (it may
+     * synchronize them with a barrier), so we can only start running
+     * it once every thread has been created */
+    for(; started < n_threads; started++)
+        if(pthread_create(&threads[started].thread, NULL, parallel_thread_main, &threads[started]) != 0)
+            break;
+
+    if(started < n_threads)
+        rc = ENOMEM;
+
+    pthread_mutex_lock(&start.lock);
+    start.state = (rc == SUCCESS) ? PARALLEL_GO : PARALLEL_ABORT;
+    pthread_cond_broadcast(&start.cond);
+    pthread_mutex_unlock(&start.lock);
+
+    if(rc == SUCCESS)
+        fn(0, n_threads, arg);
+
+    for(unsigned int i = 1; i < started; i++)
+        pthread_join(threads[i].thread, NULL);
+
+    pthread_mutex_destroy(&start.lock);
+    pthread_cond_destroy(&start.cond);
+    free(threads);
+
+    return rc;
+}
+
+
+/* See parallel.h */
+void parallel_block(unsigned long n, unsigned int tid, unsigned int n_threads,
+                    unsigned long *begin, unsigned long *end)
+{
+    *begin = n * tid / n_threads;
+    *end = n * (tid + 1) / n_threads;
+}
+
+
+/* State shared by the threads running parallel_sort */
+typedef struct parallel_sort {
+    char *base;
+    char *tmp;
+    size_t n;
+    size_t size;
+    int (*cmp)(const void *, const void *);
+    pthread_barrier_t barrier;
+} parallel_sort_t;
+
+
+/*
+ * Helper function: merges two sorted runs of elements
+ *
+ * Parameters:
+ *  - s: The sort state
+ *  - a, n_a: The first run and its number of elements
+ *  - b, n_b: The second run and its number of elements
+ *  - out: Where the merged elements are stored
+ */
+static void parallel_merge(parallel_sort_t *s, char *a, size_t n_a,
+                           char *b, size_t n_b, char *out)
+{
+    char *a_end = a + n_a * s->size, *b_end = b + n_b * s->size;
+
+    while(a < a_end && b < b_end)
+    {
+        /* On ties, the first run goes first, so the merge is stable */
+        if(s->cmp(b, a) < 0)
+        {
+            memcpy(out, b, s->size);
+            b += s->size;
+        }
+        else
+        {
+            memcpy(out, a, s->size);
+            a += s->size;
+        }
+        out += s->size;
+    }
+
+    memcpy(out, a, a_end - a);
+    memcpy(out + (a_end - a), b, b_end - b);
+}
+
+
+/* Function run by each thread of parallel_sort */
+static void parallel_sort_thread(unsigned int tid, unsigned int n_threads, void *arg)
+{
+    parallel_sort_t *s = arg;
+    char *src = s->base, *dst = s->tmp;
+    unsigned long begin, mid, end, unused;
+
+    /* Each thread sorts its own block... */
+    parallel_block(s->n, tid, n_threads, &begin, &end);
+    qsort(src + begin * s->size, end - begin, s->size, s->cmp);
+
+    /* ...and then the sorted blocks are merged pairwise, with the
+     * number of threads doing merges halving at every round */
+    for(unsigned int width = 1; width < n_threads; width *= 2)
+    {
+        pthread_barrier_wait(&s->barrier);
+
+        if(tid % (2 * width) == 0)
+        {
+            unsigned int last = tid + 2 * width < n_threads ? tid + 2 * width : n_threads;
+
+            parallel_block(s->n, tid, n_threads, &begin, &unused);
+            parallel_block(s->n, last - 1, n_threads, &unused, &end);
+
+            if(tid + width < n_threads)
+                parallel_block(s->n, tid + width, n_threads, &mid, &unused);
+            else
+                mid = end;
+
+            parallel_merge(s, src + begin * s->size, mid - begin,
+                           src + mid * s->size, end - mid, dst + begin * s->size);
+        }
+
+        char *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    /* If the result ended up in the temporary array, copy it back */
+    if(src != s->base)
+    {
+        pthread_barrier_wait(&s->barrier);
+        parallel_block(s->n, tid, n_threads, &begin, &end);
+        memcpy(s->base + begin * s->size, src + begin * s->size, (end - begin) * s->size);
+    }
+}
+
+
+/* See parallel.h */
+int parallel_sort(void *base, size_t n, size_t size,
+                  int (*cmp)(const void *, const void *), unsigned int n_threads)
+{
+    parallel_sort_t s;
+    int rc;
+
+    n_threads = parallel_threads(n_threads);
+
+    /* Not worth it for small arrays */
+    if(n_threads == 1 || n < PARALLEL_SORT_MIN * n_threads)
+    {
+        qsort(base, n, size, cmp);
+        return SUCCESS;
+    }
+
+    s.base = base;
+    s.tmp = malloc(n * size);
+    s.n = n;
+    s.size = size;
+    s.cmp = cmp;
+
+    if(s.tmp == NULL)
+        return ENOMEM;
+
+    pthread_barrier_init(&s.barrier, NULL, n_threads);
+    rc = parallel_run(n_threads, parallel_sort_thread, &s);
+    pthread_barrier_destroy(&s.barrier);
+
+    free(s.tmp);
+
+    return rc;
+}
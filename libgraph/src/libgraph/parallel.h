@@ -0,0 +1,86 @@
+/*
+ * Helpers for running code on several threads
+ *
+ * This is an internal header, used by the multithreaded algorithms.
+ * It is not installed along with the public headers in include/.
+ *
+ */
+
+#ifndef SRC_LIBGRAPH_PARALLEL_H_
+#define SRC_LIBGRAPH_PARALLEL_H_
+
+#include <stddef.h>
+
+
+/* Smallest number of elements per thread for which
+ * parallel_sort uses several threads */
+#define PARALLEL_SORT_MIN (4096)
+
+
+/*
+ * Function run by each thread
+ *
+ * Parameters:
+ *  - tid: Number of this thread (between 0 and n_threads-1)
+ *  - n_threads: Number of threads running the function
+ *  - arg: The argument passed to parallel_run
+ */
+typedef void (*parallel_fn)(unsigned int tid, unsigned int n_threads, void *arg);
+
+/*
+ * Returns the number of threads to use
+ *
+ * Parameters:
+ *  - requested: Number of threads requested by the user
+ *
+ * Returns:
+ *  - 'requested' if it is non-zero. Otherwise, the number of
+ *    processors available.
+ */
+unsigned int parallel_threads(unsigned int requested);
+
+/*
+ * Runs a function on several threads, and waits for all of them to
+ * finish. Thread 0 is the calling thread.
+ *
+ * Parameters:
+ *  - n_threads: Number of threads (at least 1)
+ *  - fn: The function to run
+ *  - arg: Argument to pass to the function
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If the threads could not be created
+ */
+int parallel_run(unsigned int n_threads, parallel_fn fn, void *arg);
+
+/*
+ * Splits the range [0, n) into n_threads contiguous blocks,
+ * and returns the block assigned to a thread
+ *
+ * Parameters:
+ *  - n: Size of the range
+ *  - tid, n_threads: As passed to a parallel_fn
+ *  - begin, end: Out parameters for the block
+ */
+void parallel_block(unsigned long n, unsigned int tid, unsigned int n_threads,
+                    unsigned long *begin, unsigned long *end);
+
+/*
+ * Sorts an array using several threads. Each thread sorts a block of
+ * the array with qsort, and then the blocks are merged. Takes a
+ * temporary array as large as the one being sorted.
+ *
+ * Parameters:
+ *  - base, n, size, cmp: As for qsort
+ *  - n_threads: Number of threads to use (0 to use one thread
+ *               per processor)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+int parallel_sort(void *base, size_t n, size_t size,
+                  int (*cmp)(const void *, const void *), unsigned int n_threads);
+
+#endif
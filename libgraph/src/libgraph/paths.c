@@ -0,0 +1,118 @@
+#include "algorithms.h"
+#include "heap.h"
+#include "counters.h"
+#include <stdlib.h>
+#include <math.h>
+
+
+/*
+ * Helper function: runs Dijkstra's algorithm
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - source: The numerical index of the source vertex
+ *  - target: Index of the vertex to stop at, or GRAPH_NO_VERTEX
+ *            to compute the paths to every vertex
+ *  - dist, pred: See graph_shortest_paths
+ *
+ * Returns:
+ *  - See graph_shortest_paths
+ */
+static int dijkstra(graph_t *g, unsigned int source, unsigned int target,
+                    double *dist, unsigned int *pred)
+{
+    iheap_t heap;
+    int rc;
+
+    if(source >= g->n_vertices)
+        return EINDEX;
+
+    rc = iheap_init(&heap, g->n_vertices, IHEAP_DEFAULT_ARITY);
+    if(rc != SUCCESS)
+        return rc;
+
+    STATS_ALLOC(2);
+
+    for(unsigned int i = 0; i < g->n_vertices; i++)
+    {
+        dist[i] = INFINITY;
+        if(pred != NULL)
+            pred[i] = GRAPH_NO_VERTEX;
+    }
+
+    dist[source] = 0.0;
+    iheap_push(&heap, source, 0.0);
+
+    while(heap.size > 0)
+    {
+        unsigned int i;
+        double d;
+
+        iheap_pop(&heap, &i, &d);
+        STATS_VERTICES(1);
+
+        /* Once a vertex leaves the heap, its distance is final */
+        if(i == target)
+            break;
+
+        STATS_EDGES(g->vertices[i].degree);
+
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned int i_next = e->to - g->vertices;
+            double d_next = d + e->weight;
+
+            if(e->weight < 0)
+            {
+                rc = EINVAL;
+                break;
+            }
+
+            if(d_next < dist[i_next])
+            {
+                dist[i_next] = d_next;
+                if(pred != NULL)
+                    pred[i_next] = i;
+                iheap_push(&heap, i_next, d_next);
+                STATS_QUEUE(heap.size);
+            }
+        }
+
+        if(rc != SUCCESS)
+            break;
+    }
+
+    iheap_free(&heap);
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_shortest_paths(graph_t *g, unsigned int source, double *dist, unsigned int *pred)
+{
+    int rc;
+
+    STATS_BEGIN();
+    rc = dijkstra(g, source, GRAPH_NO_VERTEX, dist, pred);
+    STATS_END();
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_shortest_path(graph_t *g, unsigned int source, unsigned int target,
+                        double *dist, unsigned int *pred)
+{
+    int rc;
+
+    if(target >= g->n_vertices)
+        return EINDEX;
+
+    STATS_BEGIN();
+    rc = dijkstra(g, source, target, dist, pred);
+    STATS_END();
+
+    return rc;
+}
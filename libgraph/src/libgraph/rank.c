@@ -0,0 +1,385 @@
+#include "algorithms.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+
+/* SPARSE MATRIX-VECTOR PRODUCTS
+ *
+ * A CSR snapshot is the adjacency matrix of a graph in compressed sparse
+ * row format, so multiplying it by a vector is a "pull": each entry of
+ * the result is computed from the entries of the vector at the targets
+ * of the edges of one vertex. Every entry is written by exactly one
+ * thread, so no atomics are needed. The rows are split between the
+ * threads so that each of them gets about the same number of edges,
+ * since a few vertices with many edges can make an even split of
+ * the rows very unbalanced.
+ */
+
+/*
+ * Helper function: splits the rows of a CSR snapshot into n_threads
+ * blocks with about the same number of edges, and returns the block
+ * assigned to a thread
+ *
+ * Parameters:
+ *  - csr: The snapshot
+ *  - tid, n_threads: As passed to a parallel_fn
+ *  - begin, end: Out parameters for the block of rows
+ */
+static void spmv_block(graph_csr_t *csr, unsigned int tid, unsigned int n_threads,
+                       unsigned long *begin, unsigned long *end)
+{
+    unsigned long bounds[2];
+
+    /* Block t starts at the first row whose edges start at or after
+     * a fraction t/n_threads of the edges (plus the rows, so that
+     * rows without edges are split evenly too) */
+    for(unsigned int b = 0; b < 2; b++)
+    {
+        unsigned long n = csr->n_vertices;
+        unsigned long goal = (csr->n_edges + n) * (tid + b) / n_threads;
+        unsigned long lo = 0, hi = n;
+
+        while(lo < hi)
+        {
+            unsigned long mid = lo + (hi - lo) / 2;
+            if(csr->offsets[mid] + mid < goal)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        bounds[b] = lo;
+    }
+
+    *begin = bounds[0];
+    *end = tid + 1 == n_threads ? csr->n_vertices : bounds[1];
+}
+
+
+/*
+ * Helper function: computes a block of rows of a sparse matrix-vector
+ * product. The sum for each row is split between four accumulators, so
+ * the additions do not have to wait for each other.
+ *
+ * Parameters:
+ *  - csr: The matrix
+ *  - weighted: Whether to use the weights of the edges (if false,
+ *              they are taken to be 1)
+ *  - x: The vector
+ *  - y: The result
+ *  - begin, end: The block of rows
+ */
+static void spmv_rows(graph_csr_t *csr, bool weighted, const double *restrict x,
+                      double *restrict y, unsigned long begin, unsigned long end)
+{
+    const unsigned int *restrict targets = csr->targets;
+    const double *restrict weights = csr->weights;
+
+    for(unsigned long i = begin; i < end; i++)
+    {
+        unsigned long k = csr->offsets[i], k_end = csr->offsets[i + 1];
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+
+        if(weighted)
+        {
+            for(; k + 4 <= k_end; k += 4)
+            {
+                s0 += weights[k] * x[targets[k]];
+                s1 += weights[k + 1] * x[targets[k + 1]];
+                s2 += weights[k + 2] * x[targets[k + 2]];
+                s3 += weights[k + 3] * x[targets[k + 3]];
+            }
+
+            for(; k < k_end; k++)
+                s0 += weights[k] * x[targets[k]];
+        }
+        else
+        {
+            for(; k + 4 <= k_end; k += 4)
+            {
+                s0 += x[targets[k]];
+                s1 += x[targets[k + 1]];
+                s2 += x[targets[k + 2]];
+                s3 += x[targets[k + 3]];
+            }
+
+            for(; k < k_end; k++)
+                s0 += x[targets[k]];
+        }
+
+        y[i] = (s0 + s1) + (s2 + s3);
+    }
+}
+
+
+/* Arguments of the threads running graph_csr_spmv */
+typedef struct spmv {
+    graph_csr_t *csr;
+    const double *x;
+    double *y;
+} spmv_t;
+
+
+/* Function run by each thread of graph_csr_spmv */
+static void spmv_thread(unsigned int tid, unsigned int n_threads, void *arg)
+{
+    spmv_t *s = arg;
+    unsigned long begin, end;
+
+    spmv_block(s->csr, tid, n_threads, &begin, &end);
+    spmv_rows(s->csr, true, s->x, s->y, begin, end);
+}
+
+
+/* See algorithms.h */
+int graph_csr_spmv(graph_csr_t *csr, const double *x, double *y, unsigned int n_threads)
+{
+    spmv_t s = { csr, x, y };
+
+    return parallel_run(parallel_threads(n_threads), spmv_thread, &s);
+}
+
+
+/* PAGERANK
+ *
+ * Each iteration computes the new rank of every vertex by pulling the
+ * contributions of the vertices with edges to it, which are the edges
+ * of the vertex in a transposed snapshot. The contribution of a vertex
+ * is its rank divided by its out-degree, and is computed beforehand, so
+ * the pull itself is an unweighted sparse matrix-vector product. The
+ * rank of vertices without outgoing edges is spread over all the
+ * vertices.
+ *
+ * When the snapshot comes from graph_pagerank, the vertices removed from
+ * the graph are left out: they keep a rank of 0, and n is the number of
+ * vertices that are left.
+ */
+
+/* State shared by the threads running PageRank */
+typedef struct pagerank {
+    graph_csr_t *in;
+    unsigned int *out_degree;
+
+    /* The vertices of the source graph, to skip the removed ones
+     * (NULL if every vertex of the snapshot is used), and the number
+     * of vertices that are used */
+    const vertex_t *vertices;
+    unsigned long n_live;
+
+    double damping;
+    double tolerance;
+    unsigned int max_iter;
+
+    /* Current ranks, contributions and new ranks */
+    double *rank;
+    double *contrib;
+    double *next;
+
+    /* Per-thread sums of the rank of the vertices without outgoing
+     * edges, and of the changes in rank */
+    double *dangling;
+    double *change;
+
+    /* Set by thread 0 */
+    unsigned int n_iter;
+    bool done;
+
+    pthread_barrier_t barrier;
+} pagerank_t;
+
+
+/* Function run by each thread of PageRank */
+static void pagerank_thread(unsigned int tid, unsigned int n_threads, void *arg)
+{
+    pagerank_t *s = arg;
+    unsigned long n = s->in->n_vertices;
+    unsigned long v_begin, v_end, r_begin, r_end;
+
+    parallel_block(n, tid, n_threads, &v_begin, &v_end);
+    spmv_block(s->in, tid, n_threads, &r_begin, &r_end);
+
+    while(!s->done)
+    {
+        double dangling = 0.0;
+
+        for(unsigned long i = v_begin; i < v_end; i++)
+        {
+            if(s->out_degree[i] > 0)
+                s->contrib[i] = s->rank[i] / s->out_degree[i];
+            else if(s->vertices != NULL && s->vertices[i].removed)
+                s->contrib[i] = 0.0;
+            else
+            {
+                s->contrib[i] = 0.0;
+                dangling += s->rank[i];
+            }
+        }
+
+        s->dangling[tid] = dangling;
+        pthread_barrier_wait(&s->barrier);
+
+        dangling = 0.0;
+        for(unsigned int t = 0; t < n_threads; t++)
+            dangling += s->dangling[t];
+
+        double base = (1.0 - s->damping) / s->n_live + s->damping * dangling / s->n_live;
+        double change = 0.0;
+
+        spmv_rows(s->in, false, s->contrib, s->next, r_begin, r_end);
+
+        for(unsigned long i = r_begin; i < r_end; i++)
+        {
+            /* Removed vertices have no edges, so their rank stays at 0 */
+            if(s->vertices != NULL && s->vertices[i].removed)
+                continue;
+
+            s->next[i] = base + s->damping * s->next[i];
+            change += fabs(s->next[i] - s->rank[i]);
+        }
+
+        s->change[tid] = change;
+        pthread_barrier_wait(&s->barrier);
+
+        if(tid == 0)
+        {
+            change = 0.0;
+            for(unsigned int t = 0; t < n_threads; t++)
+                change += s->change[t];
+
+            double *swap = s->rank;
+            s->rank = s->next;
+            s->next = swap;
+
+            s->n_iter++;
+            s->done = change < s->tolerance || s->n_iter == s->max_iter;
+        }
+
+        pthread_barrier_wait(&s->barrier);
+    }
+}
+
+
+/*
+ * Helper function: computes the PageRank of the vertices of a transposed
+ * snapshot, for graph_csr_pagerank and graph_pagerank
+ *
+ * Parameters:
+ *  - in, damping, tolerance, max_iter, n_threads, rank, n_iter:
+ *    See graph_csr_pagerank
+ *  - vertices: The vertices of the graph the snapshot was built from,
+ *              whose removed vertices are skipped (or NULL to use every
+ *              vertex of the snapshot)
+ *
+ * Returns:
+ *  - See graph_csr_pagerank
+ */
+static int pagerank_run(graph_csr_t *in, const vertex_t *vertices, double damping,
+                        double tolerance, unsigned int max_iter, unsigned int n_threads,
+                        double *rank, unsigned int *n_iter)
+{
+    unsigned long n = in->n_vertices;
+    unsigned long n_live = n;
+    pagerank_t s;
+    int rc;
+
+    if(!in->transposed || damping < 0.0 || damping > 1.0)
+        return EINVAL;
+
+    if(n_iter != NULL)
+        *n_iter = 0;
+
+    if(vertices != NULL)
+        for(unsigned long i = 0; i < n; i++)
+            if(vertices[i].removed)
+                n_live--;
+
+    for(unsigned long i = 0; i < n; i++)
+        rank[i] = vertices != NULL && vertices[i].removed ? 0.0 : 1.0 / n_live;
+
+    if(n_live == 0 || max_iter == 0)
+        return SUCCESS;
+
+    n_threads = parallel_threads(n_threads);
+
+    s.in = in;
+    s.vertices = vertices;
+    s.n_live = n_live;
+    s.damping = damping;
+    s.tolerance = tolerance;
+    s.max_iter = max_iter;
+    s.rank = rank;
+    s.n_iter = 0;
+    s.done = false;
+    s.out_degree = calloc(n, sizeof(unsigned int));
+    s.contrib = malloc(n * sizeof(double));
+    s.next = malloc(n * sizeof(double));
+    s.dangling = malloc(n_threads * sizeof(double));
+    s.change = malloc(n_threads * sizeof(double));
+
+    if(s.out_degree == NULL || s.contrib == NULL || s.next == NULL ||
+       s.dangling == NULL || s.change == NULL)
+    {
+        rc = ENOMEM;
+        goto out;
+    }
+
+    /* In a transposed snapshot, each edge's target is where it comes from */
+    for(unsigned long k = 0; k < in->n_edges; k++)
+        s.out_degree[in->targets[k]]++;
+
+    pthread_barrier_init(&s.barrier, NULL, n_threads);
+    rc = parallel_run(n_threads, pagerank_thread, &s);
+    pthread_barrier_destroy(&s.barrier);
+
+    /* After an odd number of iterations, the final ranks are in the
+     * array that was allocated here */
+    if(rc == SUCCESS && s.rank != rank)
+    {
+        for(unsigned long i = 0; i < n; i++)
+            rank[i] = s.rank[i];
+        s.next = s.rank;
+    }
+
+    if(rc == SUCCESS && n_iter != NULL)
+        *n_iter = s.n_iter;
+
+out:
+    free(s.out_degree);
+    free(s.contrib);
+    free(s.next);
+    free(s.dangling);
+    free(s.change);
+
+    return rc;
+}
+
+
+/* See algorithms.h */
+int graph_csr_pagerank(graph_csr_t *in, double damping, double tolerance,
+                       unsigned int max_iter, unsigned int n_threads,
+                       double *rank, unsigned int *n_iter)
+{
+    return pagerank_run(in, NULL, damping, tolerance, max_iter, n_threads, rank, n_iter);
+}
+
+
+/* See algorithms.h */
+int graph_pagerank(graph_t *g, double damping, double tolerance,
+                   unsigned int max_iter, unsigned int n_threads,
+                   double *rank, unsigned int *n_iter)
+{
+    graph_csr_t in;
+    int rc;
+
+    rc = graph_freeze_transpose(g, &in);
+    if(rc != SUCCESS)
+        return rc;
+
+    rc = pagerank_run(&in, g->vertices, damping, tolerance, max_iter, n_threads, rank, n_iter);
+
+    graph_csr_free(&in);
+
+    return rc;
+}
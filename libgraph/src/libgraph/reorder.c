@@ -0,0 +1,311 @@
+#include "algorithms.h"
+#include <stdlib.h>
+
+
+/* A vertex and the key it is sorted by */
+typedef struct reorder_key {
+    unsigned long key;
+    unsigned int index;
+} reorder_key_t;
+
+
+/* Orders vertices by key, breaking ties by index, for qsort */
+static int reorder_key_cmp(const void *p1, const void *p2)
+{
+    const reorder_key_t *k1 = p1, *k2 = p2;
+
+    if(k1->key != k2->key)
+        return k1->key < k2->key ? -1 : 1;
+
+    return (k1->index > k2->index) - (k1->index < k2->index);
+}
+
+
+/*
+ * Helper function: computes the Reverse Cuthill-McKee order of a graph.
+ * Each connected component (ignoring the direction of the edges) is
+ * traversed in BFS order, starting from one of its vertices with the
+ * fewest neighbours and adding the neighbours of each vertex in order
+ * of increasing degree, and the whole order is then reversed. This
+ * keeps the neighbours of every vertex close to it (i.e., it reduces
+ * the bandwidth of the adjacency matrix).
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - order: Out parameter for the vertices that have not been removed,
+ *           in their new order
+ *
+ * Returns:
+ *  - The number of vertices stored in order, or ENOMEM
+ */
+static long reorder_rcm(graph_t *g, unsigned int *order)
+{
+    unsigned int n = g->n_vertices;
+    graph_csr_t out, in;
+    long rc;
+
+    rc = graph_freeze(g, &out);
+    if(rc != SUCCESS)
+        return rc;
+
+    rc = graph_freeze_transpose(g, &in);
+    if(rc != SUCCESS)
+    {
+        graph_csr_free(&out);
+        return rc;
+    }
+
+    reorder_key_t *by_degree = malloc((n > 0 ? n : 1) * sizeof(reorder_key_t));
+    reorder_key_t *next = malloc((n > 0 ? n : 1) * sizeof(reorder_key_t));
+    unsigned long *degree = malloc((n > 0 ? n : 1) * sizeof(unsigned long));
+    bool *visited = calloc(n > 0 ? n : 1, sizeof(bool));
+
+    if(by_degree == NULL || next == NULL || degree == NULL || visited == NULL)
+    {
+        free(by_degree);
+        free(next);
+        free(degree);
+        free(visited);
+        graph_csr_free(&out);
+        graph_csr_free(&in);
+        return ENOMEM;
+    }
+
+    unsigned int n_live = 0;
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        degree[i] = (out.offsets[i + 1] - out.offsets[i]) + (in.offsets[i + 1] - in.offsets[i]);
+
+        if(!g->vertices[i].removed)
+        {
+            by_degree[n_live].key = degree[i];
+            by_degree[n_live].index = i;
+            n_live++;
+        }
+    }
+
+    qsort(by_degree, n_live, sizeof(reorder_key_t), reorder_key_cmp);
+
+    /* order[head..len) is the BFS queue */
+    unsigned int head = 0, len = 0;
+
+    for(unsigned int s = 0; s < n_live; s++)
+    {
+        if(visited[by_degree[s].index])
+            continue;
+
+        visited[by_degree[s].index] = true;
+        order[len++] = by_degree[s].index;
+
+        while(head < len)
+        {
+            unsigned int i = order[head++];
+            unsigned int n_next = 0;
+
+            for(int t = 0; t < 2; t++)
+            {
+                graph_csr_t *csr = t == 0 ? &out : &in;
+
+                for(unsigned long k = csr->offsets[i]; k < csr->offsets[i + 1]; k++)
+                {
+                    unsigned int j = csr->targets[k];
+
+                    if(visited[j])
+                        continue;
+
+                    visited[j] = true;
+                    next[n_next].key = degree[j];
+                    next[n_next].index = j;
+                    n_next++;
+                }
+            }
+
+            qsort(next, n_next, sizeof(reorder_key_t), reorder_key_cmp);
+
+            for(unsigned int k = 0; k < n_next; k++)
+                order[len++] = next[k].index;
+        }
+    }
+
+    for(unsigned int k = 0; k < len / 2; k++)
+    {
+        unsigned int tmp = order[k];
+        order[k] = order[len - 1 - k];
+        order[len - 1 - k] = tmp;
+    }
+
+    free(by_degree);
+    free(next);
+    free(degree);
+    free(visited);
+    graph_csr_free(&out);
+    graph_csr_free(&in);
+
+    return len;
+}
+
+
+/*
+ * Helper function: sorts the vertices of a graph by decreasing degree
+ * (counting both incoming and outgoing edges), so the vertices with the
+ * most edges, which are the ones visited most often, are kept together
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - order: Out parameter for the vertices that have not been removed,
+ *           in their new order
+ *
+ * Returns:
+ *  - The number of vertices stored in order, or ENOMEM
+ */
+static long reorder_degree(graph_t *g, unsigned int *order)
+{
+    unsigned int n = g->n_vertices;
+    reorder_key_t *keys = malloc((n > 0 ? n : 1) * sizeof(reorder_key_t));
+    unsigned long *degree = calloc(n > 0 ? n : 1, sizeof(unsigned long));
+
+    if(keys == NULL || degree == NULL)
+    {
+        free(keys);
+        free(degree);
+        return ENOMEM;
+    }
+
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            degree[i]++;
+            degree[e->to - g->vertices]++;
+        }
+
+    /* Sorting by the complement of the degree puts the highest
+     * degrees first, while ties are still broken by increasing index */
+    unsigned int n_live = 0;
+
+    for(unsigned int i = 0; i < n; i++)
+        if(!g->vertices[i].removed)
+        {
+            keys[n_live].key = ~degree[i];
+            keys[n_live].index = i;
+            n_live++;
+        }
+
+    qsort(keys, n_live, sizeof(reorder_key_t), reorder_key_cmp);
+
+    for(unsigned int k = 0; k < n_live; k++)
+        order[k] = keys[k].index;
+
+    free(keys);
+    free(degree);
+
+    return n_live;
+}
+
+
+/*
+ * Helper function: computes the order in which a BFS visits the vertices
+ * of a graph, following the edges in their direction. Whenever the BFS
+ * runs out of vertices, it starts again from the lowest unvisited index.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - order: Out parameter for the vertices that have not been removed,
+ *           in their new order
+ *
+ * Returns:
+ *  - The number of vertices stored in order, or ENOMEM
+ */
+static long reorder_bfs(graph_t *g, unsigned int *order)
+{
+    unsigned int n = g->n_vertices;
+    bool *visited = calloc(n > 0 ? n : 1, sizeof(bool));
+    unsigned int head = 0, len = 0;
+
+    if(visited == NULL)
+        return ENOMEM;
+
+    for(unsigned int s = 0; s < n; s++)
+    {
+        if(visited[s] || g->vertices[s].removed)
+            continue;
+
+        visited[s] = true;
+        order[len++] = s;
+
+        while(head < len)
+        {
+            unsigned int i = order[head++];
+
+            for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+            {
+                unsigned int j = e->to - g->vertices;
+
+                if(!visited[j])
+                {
+                    visited[j] = true;
+                    order[len++] = j;
+                }
+            }
+        }
+    }
+
+    free(visited);
+
+    return len;
+}
+
+
+/* See algorithms.h */
+int graph_reorder(graph_t *g, int method, unsigned int *old_to_new, unsigned int *new_to_old)
+{
+    unsigned int n = g->n_vertices;
+    unsigned int *order = new_to_old, *map = old_to_new;
+    long len;
+    int rc;
+
+    if(method != GRAPH_ORDER_RCM && method != GRAPH_ORDER_DEGREE && method != GRAPH_ORDER_BFS)
+        return EINVAL;
+
+    if(order == NULL)
+        order = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    if(map == NULL)
+        map = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+
+    if(order == NULL || map == NULL)
+    {
+        rc = ENOMEM;
+        goto out;
+    }
+
+    if(method == GRAPH_ORDER_RCM)
+        len = reorder_rcm(g, order);
+    else if(method == GRAPH_ORDER_DEGREE)
+        len = reorder_degree(g, order);
+    else
+        len = reorder_bfs(g, order);
+
+    if(len < 0)
+    {
+        rc = len;
+        goto out;
+    }
+
+    /* Removed vertices go last */
+    for(unsigned int i = 0; i < n; i++)
+        if(g->vertices[i].removed)
+            order[len++] = i;
+
+    for(unsigned int k = 0; k < n; k++)
+        map[order[k]] = k;
+
+    rc = graph_permute(g, map);
+
+out:
+    if(order != new_to_old)
+        free(order);
+    if(map != old_to_new)
+        free(map);
+
+    return rc;
+}
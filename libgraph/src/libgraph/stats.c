@@ -0,0 +1,79 @@
+#include "counters.h"
+#include <time.h>
+
+
+#ifdef GRAPH_ENABLE_STATS
+
+/* See counters.h */
+_Thread_local graph_stats_t stats_current;
+
+/* Statistics of the last call made by this thread */
+static _Thread_local graph_stats_t stats_last;
+static _Thread_local bool stats_recorded;
+
+/* Nesting depth of the instrumented calls in progress,
+ * and the time at which the outermost one started */
+static _Thread_local unsigned int stats_depth;
+static _Thread_local struct timespec stats_start;
+
+
+/* See counters.h */
+void stats_begin(const char *function)
+{
+    if(stats_depth++ > 0)
+        return;
+
+    stats_current = (graph_stats_t) { .function = function };
+    clock_gettime(CLOCK_MONOTONIC, &stats_start);
+}
+
+
+/* See counters.h */
+void stats_end(void)
+{
+    struct timespec end;
+
+    if(--stats_depth > 0)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    stats_current.seconds = (end.tv_sec - stats_start.tv_sec) +
+                            (end.tv_nsec - stats_start.tv_nsec) / 1e9;
+
+    stats_last = stats_current;
+    stats_recorded = true;
+}
+
+
+/* See stats.h */
+int graph_stats_last(graph_stats_t *stats)
+{
+    if(!stats_recorded)
+        return ENOTFOUND;
+
+    *stats = stats_last;
+
+    return SUCCESS;
+}
+
+#else
+
+/* See stats.h */
+int graph_stats_last(graph_stats_t *stats)
+{
+    (void) stats;
+
+    return EINVAL;
+}
+
+#endif
+
+
+/* See stats.h */
+double graph_stats_teps(const graph_stats_t *stats)
+{
+    if(stats->seconds <= 0)
+        return 0.0;
+
+    return stats->edges_scanned / stats->seconds;
+}
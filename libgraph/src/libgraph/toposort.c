@@ -0,0 +1,420 @@
+#include "algorithms.h"
+#include "parallel.h"
+#include "counters.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+
+/*
+ * Helper function: finds a cycle among the vertices that Kahn's
+ * algorithm could not sort.
+ *
+ * Every vertex that could not be sorted still has an incoming edge from
+ * another such vertex, so walking these edges backwards from any of them
+ * must eventually revisit a vertex. The vertices between the two visits
+ * form a cycle.
+ *
+ * Parameters:
+ *  - g: The graph
+ *  - indegree: The in-degree counters left by Kahn's algorithm. The
+ *              vertices that could not be sorted are the ones with a
+ *              non-zero counter.
+ *  - cycle: Out parameter for the cycle (see graph_toposort_kahn)
+ *  - n_cycle: Out parameter for the length of the cycle
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int kahn_find_cycle(graph_t *g, unsigned int *indegree,
+                           unsigned int *cycle, unsigned int *n_cycle)
+{
+    unsigned int n = g->n_vertices;
+    unsigned int *pred = malloc(n * sizeof(unsigned int));
+
+    if(pred == NULL)
+        return ENOMEM;
+
+    /* Pick one predecessor for each unsorted vertex, among the
+     * unsorted vertices */
+    unsigned int first = GRAPH_NO_VERTEX;
+    for(unsigned int i = 0; i < n; i++)
+    {
+        if(indegree[i] == 0)
+            continue;
+
+        if(first == GRAPH_NO_VERTEX)
+            first = i;
+
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned int i_next = e->to - g->vertices;
+            if(indegree[i_next] != 0)
+                pred[i_next] = i;
+        }
+    }
+
+    /* Walk backwards until a vertex repeats. The counters of the
+     * vertices on the walk are no longer needed, so they are set to
+     * zero to mark the vertices as visited. */
+    unsigned int i = first;
+    while(indegree[i] != 0)
+    {
+        indegree[i] = 0;
+        i = pred[i];
+    }
+
+    /* i is on the cycle. Walking backwards from it again lists the
+     * cycle in reverse, so fill the output array from the end. */
+    unsigned int length = 1;
+    for(unsigned int j = pred[i]; j != i; j = pred[j])
+        length++;
+
+    unsigned int pos = length;
+    unsigned int j = i;
+    do
+    {
+        cycle[--pos] = j;
+        j = pred[j];
+    } while(j != i);
+
+    *n_cycle = length;
+
+    free(pred);
+
+    return SUCCESS;
+}
+
+
+/* See algorithms.h */
+int graph_toposort_kahn(graph_t *g, unsigned int *order,
+                        unsigned int *cycle, unsigned int *n_cycle)
+{
+    unsigned int n = g->n_vertices;
+
+    STATS_BEGIN();
+
+    unsigned int *indegree = calloc(n > 0 ? n : 1, sizeof(unsigned int));
+
+    if(indegree == NULL)
+    {
+        STATS_END();
+        return ENOMEM;
+    }
+
+    STATS_ALLOC(1);
+
+    if(n_cycle != NULL)
+        *n_cycle = 0;
+
+    for(unsigned int i = 0; i < n; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+            indegree[e->to - g->vertices]++;
+
+    /* The order array doubles as the queue of vertices whose
+     * incoming edges have all been removed */
+    unsigned int head = 0, tail = 0;
+
+    for(unsigned int i = 0; i < n; i++)
+        if(indegree[i] == 0)
+            order[tail++] = i;
+
+    while(head < tail)
+    {
+        unsigned int i = order[head++];
+
+        STATS_VERTICES(1);
+        STATS_EDGES(g->vertices[i].degree);
+
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned int i_next = e->to - g->vertices;
+            if(--indegree[i_next] == 0)
+                order[tail++] = i_next;
+        }
+
+        STATS_QUEUE(tail - head);
+    }
+
+    int rc = SUCCESS;
+
+    if(tail < n)
+    {
+        rc = ECYCLE;
+
+        if(cycle != NULL && kahn_find_cycle(g, indegree, cycle, n_cycle) != SUCCESS)
+            rc = ENOMEM;
+    }
+
+    free(indegree);
+
+    STATS_END();
+
+    return rc;
+}
+
+
+/* LEVEL-WISE TOPOLOGICAL SORT
+ *
+ * graph_toposort_levels runs Kahn's algorithm one level at a time. The
+ * vertices of a level are split among the threads, which decrement the
+ * in-degree counters of their successors atomically. The thread that
+ * takes a counter to zero adds the successor to the next level. Levels
+ * are stored one after the other in the order array, so a level is
+ * written right after the one being processed.
+ */
+
+/* Number of vertices of a level a thread claims at a time */
+#define LEVELS_CHUNK (64)
+
+/* Number of vertices in each thread's local buffer */
+#define LEVELS_BUFFER (1024)
+
+
+/* State shared by the threads running a level-wise toposort */
+typedef struct levels {
+    graph_t *g;
+    atomic_uint *indegree;
+
+    /* Output arrays */
+    unsigned int *order;
+    unsigned int *level_start;
+    unsigned int n_levels;
+
+    /* The current level is order[begin..end) */
+    unsigned int begin, end;
+
+    /* Number of vertices added to the next level so far */
+    atomic_uint next_len;
+
+    /* Position of the next chunk of the current level to process */
+    atomic_uint cursor;
+
+    pthread_barrier_t barrier;
+} levels_t;
+
+
+/*
+ * Helper function: appends a thread's local buffer to the next level
+ *
+ * Parameters:
+ *  - s: The toposort state
+ *  - buf: The buffer
+ *  - n_buf: Number of vertices in the buffer (set to zero)
+ */
+static void levels_flush(levels_t *s, unsigned int *buf, unsigned int *n_buf)
+{
+    if(*n_buf == 0)
+        return;
+
+    unsigned int pos = atomic_fetch_add_explicit(&s->next_len, *n_buf, memory_order_relaxed);
+    memcpy(s->order + s->end + pos, buf, *n_buf * sizeof(unsigned int));
+    *n_buf = 0;
+}
+
+
+/*
+ * Helper function: moves on to the next level. Must only be
+ * called by thread 0, between two barriers.
+ *
+ * Parameters:
+ *  - s: The toposort state
+ */
+static void levels_advance(levels_t *s)
+{
+    unsigned int len = atomic_load(&s->next_len);
+
+    s->begin = s->end;
+    s->end += len;
+    if(len > 0)
+        s->level_start[s->n_levels++] = s->begin;
+
+    atomic_store(&s->next_len, 0);
+    atomic_store(&s->cursor, 0);
+}
+
+
+/* Function run by each thread of a level-wise toposort */
+static void levels_thread(unsigned int tid, unsigned int n_threads, void *arg)
+{
+    levels_t *s = arg;
+    graph_t *g = s->g;
+    unsigned int buf[LEVELS_BUFFER];
+    unsigned int n_buf = 0;
+    unsigned long begin, end;
+
+    parallel_block(g->n_vertices, tid, n_threads, &begin, &end);
+
+    /* Count the incoming edges of every vertex */
+    for(unsigned long i = begin; i < end; i++)
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+            atomic_fetch_add_explicit(&s->indegree[e->to - g->vertices], 1, memory_order_relaxed);
+
+    pthread_barrier_wait(&s->barrier);
+
+    /* The first level has the vertices without incoming edges */
+    for(unsigned long i = begin; i < end; i++)
+        if(atomic_load_explicit(&s->indegree[i], memory_order_relaxed) == 0)
+        {
+            buf[n_buf++] = i;
+            if(n_buf == LEVELS_BUFFER)
+                levels_flush(s, buf, &n_buf);
+        }
+
+    levels_flush(s, buf, &n_buf);
+
+    pthread_barrier_wait(&s->barrier);
+    if(tid == 0)
+        levels_advance(s);
+    pthread_barrier_wait(&s->barrier);
+
+    while(s->begin < s->end)
+    {
+        /* Process chunks of the current level until there are none left */
+        while(true)
+        {
+            unsigned int first = s->begin + atomic_fetch_add_explicit(&s->cursor, LEVELS_CHUNK, memory_order_relaxed);
+            if(first >= s->end)
+                break;
+
+            unsigned int last = first + LEVELS_CHUNK;
+            if(last > s->end)
+                last = s->end;
+
+            for(unsigned int k = first; k < last; k++)
+            {
+                unsigned int i = s->order[k];
+
+                for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+                {
+                    unsigned int i_next = e->to - g->vertices;
+
+                    if(atomic_fetch_sub_explicit(&s->indegree[i_next], 1, memory_order_relaxed) != 1)
+                        continue;
+
+                    buf[n_buf++] = i_next;
+                    if(n_buf == LEVELS_BUFFER)
+                        levels_flush(s, buf, &n_buf);
+                }
+            }
+        }
+
+        levels_flush(s, buf, &n_buf);
+
+        pthread_barrier_wait(&s->barrier);
+        if(tid == 0)
+            levels_advance(s);
+        pthread_barrier_wait(&s->barrier);
+    }
+}
+
+
+/* See algorithms.h */
+int graph_toposort_levels(graph_t *g, unsigned int n_threads, unsigned int *order,
+                          unsigned int *level_start, unsigned int *n_levels)
+{
+    levels_t s;
+    int rc;
+
+    n_threads = parallel_threads(n_threads);
+
+    s.g = g;
+    s.indegree = calloc(g->n_vertices > 0 ? g->n_vertices : 1, sizeof(atomic_uint));
+    s.order = order;
+    s.level_start = level_start;
+    s.n_levels = 0;
+    s.begin = 0;
+    s.end = 0;
+    atomic_init(&s.next_len, 0);
+    atomic_init(&s.cursor, 0);
+
+    if(s.indegree == NULL)
+        return ENOMEM;
+
+    pthread_barrier_init(&s.barrier, NULL, n_threads);
+    rc = parallel_run(n_threads, levels_thread, &s);
+    pthread_barrier_destroy(&s.barrier);
+
+    free(s.indegree);
+
+    if(rc != SUCCESS)
+        return rc;
+
+    level_start[s.n_levels] = s.end;
+    *n_levels = s.n_levels;
+
+    if(s.end < g->n_vertices)
+        return ECYCLE;
+
+    return SUCCESS;
+}
+
+
+/* See algorithms.h */
+int graph_critical_path(graph_t *g, unsigned int *order, double *length,
+                        unsigned int *path, unsigned int *n_path)
+{
+    unsigned int n = g->n_vertices;
+
+    *length = 0.0;
+    *n_path = 0;
+
+    if(n == 0)
+        return SUCCESS;
+
+    double *finish = calloc(n, sizeof(double));
+    unsigned int *pred = malloc(n * sizeof(unsigned int));
+
+    if(finish == NULL || pred == NULL)
+    {
+        free(finish);
+        free(pred);
+        return ENOMEM;
+    }
+
+    for(unsigned int i = 0; i < n; i++)
+        pred[i] = GRAPH_NO_VERTEX;
+
+    /* finish[i] is the length of the longest path ending at vertex i.
+     * Vertices are visited in topological order, so it is final by
+     * the time vertex i is visited. */
+    unsigned int last = order[0];
+
+    for(unsigned int k = 0; k < n; k++)
+    {
+        unsigned int i = order[k];
+
+        if(finish[i] > finish[last])
+            last = i;
+
+        for(edge_t *e = g->vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned int i_next = e->to - g->vertices;
+
+            if(pred[i_next] == GRAPH_NO_VERTEX || finish[i] + e->weight > finish[i_next])
+            {
+                finish[i_next] = finish[i] + e->weight;
+                pred[i_next] = i;
+            }
+        }
+    }
+
+    /* Follow the predecessors back from the end of the path */
+    unsigned int count = 0;
+    for(unsigned int i = last; i != GRAPH_NO_VERTEX; i = pred[i])
+        count++;
+
+    unsigned int pos = count;
+    for(unsigned int i = last; i != GRAPH_NO_VERTEX; i = pred[i])
+        path[--pos] = i;
+
+    *length = finish[last];
+    *n_path = count;
+
+    free(finish);
+    free(pred);
+
+    return SUCCESS;
+}
@@ -0,0 +1,220 @@
+#include "vdeque.h"
+#include "counters.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Capacity of a deque initialized with a capacity of zero */
+#define VDEQUE_MIN_CAPACITY (16)
+
+
+/*
+ * Helper function: reallocates the buffer of a deque with a
+ * new capacity, moving the indices to the start of the buffer
+ *
+ * Parameters:
+ *  - q: The deque
+ *  - capacity: The new capacity (a power of two, at least q->length)
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int vdeque_resize(vdeque_t *q, unsigned int capacity)
+{
+    unsigned int *items = malloc(capacity * sizeof(unsigned int));
+    if(items == NULL)
+        return ENOMEM;
+
+    STATS_ALLOC(1);
+
+    /* The contents of the ring buffer may wrap around its end */
+    if(q->length > 0)
+    {
+        unsigned int first = q->capacity - q->head;
+        if(first > q->length)
+            first = q->length;
+
+        memcpy(items, q->items + q->head, first * sizeof(unsigned int));
+        memcpy(items + first, q->items, (q->length - first) * sizeof(unsigned int));
+    }
+
+    free(q->items);
+    q->items = items;
+    q->capacity = capacity;
+    q->head = 0;
+
+    return SUCCESS;
+}
+
+
+/*
+ * Helper function: makes sure there is room for one more index
+ *
+ * Parameters:
+ *  - q: The deque
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory
+ */
+static int vdeque_reserve(vdeque_t *q)
+{
+    if(q->length < q->capacity)
+        return SUCCESS;
+
+    return vdeque_resize(q, q->capacity > 0 ? 2 * q->capacity : VDEQUE_MIN_CAPACITY);
+}
+
+
+/* See vdeque.h */
+int vdeque_init(vdeque_t *q, unsigned int capacity)
+{
+    unsigned int c = VDEQUE_MIN_CAPACITY;
+
+    while(c < capacity && c < (1u << 31))
+        c *= 2;
+
+    q->length = 0;
+    q->capacity = 0;
+    q->head = 0;
+    q->items = NULL;
+
+    return vdeque_resize(q, c);
+}
+
+
+/* See vdeque.h */
+int vdeque_free(vdeque_t *q)
+{
+    free(q->items);
+    q->items = NULL;
+    q->capacity = 0;
+    q->length = 0;
+
+    return SUCCESS;
+}
+
+
+/* See vdeque.h */
+int vdeque_clear(vdeque_t *q)
+{
+    q->length = 0;
+    q->head = 0;
+
+    return SUCCESS;
+}
+
+
+/* See vdeque.h */
+int vdeque_insert_head(vdeque_t *q, unsigned int i)
+{
+    if(vdeque_reserve(q) != SUCCESS)
+        return ENOMEM;
+
+    q->head = (q->head - 1) & (q->capacity - 1);
+    q->items[q->head] = i;
+    q->length++;
+
+    STATS_QUEUE(q->length);
+
+    return SUCCESS;
+}
+
+
+/* See vdeque.h */
+int vdeque_insert_tail(vdeque_t *q, unsigned int i)
+{
+    if(vdeque_reserve(q) != SUCCESS)
+        return ENOMEM;
+
+    q->items[(q->head + q->length) & (q->capacity - 1)] = i;
+    q->length++;
+
+    STATS_QUEUE(q->length);
+
+    return SUCCESS;
+}
+
+
+/* See vdeque.h */
+int vdeque_remove_head(vdeque_t *q, unsigned int *i)
+{
+    if(q->length == 0)
+        return EEMPTY;
+
+    if(i != NULL)
+        *i = q->items[q->head];
+
+    q->head = (q->head + 1) & (q->capacity - 1);
+    q->length--;
+
+    return SUCCESS;
+}
+
+
+/* See vdeque.h */
+int vdeque_remove_tail(vdeque_t *q, unsigned int *i)
+{
+    if(q->length == 0)
+        return EEMPTY;
+
+    q->length--;
+
+    if(i != NULL)
+        *i = q->items[(q->head + q->length) & (q->capacity - 1)];
+
+    return SUCCESS;
+}
+
+
+/* See vdeque.h */
+int vdeque_peek_head(vdeque_t *q, unsigned int *i)
+{
+    if(q->length == 0)
+        return EEMPTY;
+
+    *i = q->items[q->head];
+
+    return SUCCESS;
+}
+
+
+/* See vdeque.h */
+int vdeque_peek_tail(vdeque_t *q, unsigned int *i)
+{
+    if(q->length == 0)
+        return EEMPTY;
+
+    *i = q->items[(q->head + q->length - 1) & (q->capacity - 1)];
+
+    return SUCCESS;
+}
+
+
+/* See vdeque.h */
+int vdeque_enqueue(vdeque_t *q, unsigned int i)
+{
+    return vdeque_insert_head(q, i);
+}
+
+
+/* See vdeque.h */
+int vdeque_dequeue(vdeque_t *q, unsigned int *i)
+{
+    return vdeque_remove_tail(q, i);
+}
+
+
+/* See vdeque.h */
+int vdeque_push(vdeque_t *q, unsigned int i)
+{
+    return vdeque_insert_head(q, i);
+}
+
+
+/* See vdeque.h */
+int vdeque_pop(vdeque_t *q, unsigned int *i)
+{
+    return vdeque_remove_head(q, i);
+}
@@ -1,4 +1,5 @@
 #include "vlist.h"
+#include "counters.h"
 #include "stdlib.h"
 
 
@@ -55,6 +56,8 @@ int vlist_insert_head(vlist_t *l, vertex_t *v)
     if(node == NULL)
         return ENOMEM;
 
+    STATS_ALLOC(1);
+
     /* Set values in node */
     node->v = v;
     node->next = l->head;
@@ -85,6 +88,8 @@ int vlist_insert_tail(vlist_t *l, vertex_t *v)
     if(node == NULL)
         return ENOMEM;
 
+    STATS_ALLOC(1);
+
     /* Set values in node */
     node->v = v;
     node->next = NULL;
@@ -0,0 +1,141 @@
+#include "workspace.h"
+#include "counters.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Number of 64-bit words needed for a bitset of n vertices */
+#define WORKSPACE_WORDS(n) (((n) + 63) / 64)
+
+
+/*
+ * Helper function: allocates the per-vertex arrays of a workspace
+ *
+ * Parameters:
+ *  - ws: The workspace. Its arrays are freed and replaced.
+ *  - n: Number of vertices to make room for
+ *
+ * Returns:
+ *  - 0 on success
+ *  - ENOMEM: If there was insufficient memory (the arrays
+ *    are then set to NULL and the capacity to zero)
+ */
+static int workspace_alloc(graph_workspace_t *ws, unsigned int n)
+{
+    unsigned int words = WORKSPACE_WORDS(n > 0 ? n : 1);
+
+    free(ws->bits);
+    free(ws->epochs);
+    free(ws->depth);
+    free(ws->parent);
+    free(ws->next_edge);
+
+    ws->bits = malloc(words * sizeof(uint64_t));
+    ws->epochs = calloc(words, sizeof(unsigned int));
+    ws->depth = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    ws->parent = malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    ws->next_edge = malloc((n > 0 ? n : 1) * sizeof(edge_t*));
+    ws->epoch = 1;
+
+    if(ws->bits == NULL || ws->epochs == NULL || ws->depth == NULL ||
+       ws->parent == NULL || ws->next_edge == NULL)
+    {
+        free(ws->bits);
+        free(ws->epochs);
+        free(ws->depth);
+        free(ws->parent);
+        free(ws->next_edge);
+        ws->bits = NULL;
+        ws->epochs = NULL;
+        ws->depth = NULL;
+        ws->parent = NULL;
+        ws->next_edge = NULL;
+        ws->capacity = 0;
+        return ENOMEM;
+    }
+
+    ws->capacity = n;
+    STATS_ALLOC(5);
+
+    return SUCCESS;
+}
+
+
+/* See workspace.h */
+int graph_workspace_init(graph_workspace_t *ws, unsigned int n)
+{
+    int rc;
+
+    ws->bits = NULL;
+    ws->epochs = NULL;
+    ws->depth = NULL;
+    ws->parent = NULL;
+    ws->next_edge = NULL;
+
+    rc = workspace_alloc(ws, n);
+    if(rc != SUCCESS)
+        return rc;
+
+    rc = vdeque_init(&ws->queue, 0);
+    if(rc != SUCCESS)
+    {
+        workspace_alloc(ws, 0);
+        return rc;
+    }
+
+    rc = vdeque_init(&ws->stack, 0);
+    if(rc != SUCCESS)
+    {
+        vdeque_free(&ws->queue);
+        workspace_alloc(ws, 0);
+        return rc;
+    }
+
+    return SUCCESS;
+}
+
+
+/* See workspace.h */
+int graph_workspace_free(graph_workspace_t *ws)
+{
+    free(ws->bits);
+    free(ws->epochs);
+    free(ws->depth);
+    free(ws->parent);
+    free(ws->next_edge);
+    vdeque_free(&ws->queue);
+    vdeque_free(&ws->stack);
+
+    ws->bits = NULL;
+    ws->epochs = NULL;
+    ws->depth = NULL;
+    ws->parent = NULL;
+    ws->next_edge = NULL;
+    ws->capacity = 0;
+
+    return SUCCESS;
+}
+
+
+/* See workspace.h */
+int graph_workspace_reset(graph_workspace_t *ws, unsigned int n)
+{
+    vdeque_clear(&ws->queue);
+    vdeque_clear(&ws->stack);
+
+    /* Growing the arrays starts over from the first epoch */
+    if(n > ws->capacity)
+        return workspace_alloc(ws, n);
+
+    ws->epoch++;
+
+    /* When the epoch counter wraps around, the words written in
+     * the epoch with the same number would seem to be current */
+    if(ws->epoch == 0)
+    {
+        memset(ws->epochs, 0, WORKSPACE_WORDS(ws->capacity > 0 ? ws->capacity : 1) * sizeof(unsigned int));
+        ws->epoch = 1;
+    }
+
+    return SUCCESS;
+}
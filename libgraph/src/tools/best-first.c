@@ -51,7 +51,7 @@ int main(int argc, char *argv[])
     vertex_t *start_vertex, *final_vertex;
     graph_t g;
 
-    rc = graph_from_file(&g, graphfile);
+    rc = graph_load(&g, graphfile);
     CHECK_STATUS(rc);
 
     rc = graph_get_vertex_lbl(&g, start_label, &start_vertex);
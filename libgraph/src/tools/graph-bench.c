@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "algorithms.h"
+#include "stats.h"
+
+
+/* Benchmarks */
+#define BENCH_LOAD       (0)
+#define BENCH_BFS        (1)
+#define BENCH_DFS_ITER   (2)
+#define BENCH_TOPOSORT   (3)
+#define BENCH_SPANNING   (4)
+#define N_BENCH          (5)
+
+/* The function timed by each benchmark. graph_bfs, graph_dfs_iter and
+ * graph_spanning_tree print every vertex they visit, so the benchmarks
+ * time the same traversals without a visitor instead. */
+static const char *bench_names[N_BENCH] = {
+    "graph_from_file",
+    "graph_bfs_traverse",
+    "graph_dfs_iter_traverse",
+    "graph_toposort",
+    "graph_spanning_tree_traverse"
+};
+
+
+/* Returns the current time, in seconds */
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* Returns the peak resident set size of the process so far, in KiB */
+static long peak_rss()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+
+/* Visitor that counts the vertices visited and the edges they have */
+static int count_visit(graph_t *g, unsigned int i, unsigned int parent, void *arg)
+{
+    unsigned long *count = arg;
+
+    (void) parent;
+
+    count[0]++;
+    count[1] += g->vertices[i].degree;
+
+    return 0;
+}
+
+
+/* Returns the vertex with the most outgoing edges (the first one, if
+ * several have as many), so the traversals don't start at an isolated
+ * vertex, as vertex 0 often is in the shuffled graphs from graph-gen */
+static unsigned int max_degree_vertex(graph_t *g)
+{
+    unsigned int best = 0;
+
+    for(unsigned int i = 1; i < g->n_vertices; i++)
+        if(g->vertices[i].degree > g->vertices[best].degree)
+            best = i;
+
+    return best;
+}
+
+
+/* Prints a string as a JSON string */
+static void print_json_string(const char *s)
+{
+    putchar('"');
+    for(; *s != '\0'; s++)
+    {
+        if(*s == '"' || *s == '\\')
+            putchar('\\');
+        putchar(*s);
+    }
+    putchar('"');
+}
+
+
+/*
+ * Runs a benchmark once
+ *
+ * Parameters:
+ *  - b: The benchmark
+ *  - g: The graph (for BENCH_LOAD, the graph to load)
+ *  - graphfile: The graph file
+ *  - start: The start vertex of the traversals
+ *  - count: Out parameter for the number of vertices and edges visited.
+ *           Can be NULL, in which case they are not counted.
+ *
+ * Returns:
+ *  - The time taken, in seconds
+ */
+static double run_bench(int b, graph_t *g, const char *graphfile,
+                        unsigned int start, unsigned long *count)
+{
+    graph_traversal_t t = { .visit = count_visit, .arg = count };
+    graph_traversal_t *pt = count != NULL ? &t : NULL;
+    graph_t *tree;
+    vlist_t *l;
+    int rc;
+
+    double time = now();
+
+    switch(b)
+    {
+        case BENCH_LOAD:
+            rc = graph_from_file(g, graphfile);
+            break;
+        case BENCH_BFS:
+            rc = graph_bfs_traverse(g, start, pt);
+            break;
+        case BENCH_DFS_ITER:
+            rc = graph_dfs_iter_traverse(g, start, pt);
+            break;
+        case BENCH_TOPOSORT:
+            rc = graph_toposort(g, start, &l);
+            break;
+        default:
+            rc = graph_spanning_tree_traverse(g, start, &tree, pt);
+            break;
+    }
+
+    time = now() - time;
+    CHECK_STATUS(rc);
+
+    if(b == BENCH_LOAD && count != NULL)
+    {
+        count[0] = g->n_vertices;
+        count[1] = g->n_edges;
+    }
+    else if(b == BENCH_TOPOSORT)
+    {
+        if(count != NULL)
+            for(vlist_node_t *node = l->head; node != NULL; node = node->next)
+            {
+                count[0]++;
+                count[1] += node->v->degree;
+            }
+
+        vlist_free(l);
+        free(l);
+    }
+    else if(b == BENCH_SPANNING)
+    {
+        graph_free(tree);
+        free(tree);
+    }
+
+    return time;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    char *graphfile = NULL;
+    unsigned int start = GRAPH_NO_VERTEX;
+    int runs = 3;
+
+    /* Parse command-line options */
+    while ((opt = getopt(argc, argv, "g:s:n:h")) != -1)
+        switch (opt)
+        {
+            case 'g':
+                graphfile = strdup(optarg);
+                break;
+            case 's':
+                start = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                runs = strtol(optarg, NULL, 10);
+                break;
+            case 'h':
+                printf("Usage: graph-bench -g GRAPH_FILE [-s START_VERTEX] [-n RUNS]\n");
+                printf("(the default start vertex is the one with the most outgoing edges)\n");
+                exit(0);
+                break;
+            default:
+                printf("ERROR: Unknown option -%c\n", opt);
+                exit(-1);
+        }
+
+    /* Validate parameters */
+    if(graphfile == NULL)
+    {
+        printf("You must specify a graph file with the -g option\n");
+        exit(-1);
+    }
+
+    if(runs < 1)
+    {
+        printf("The number of runs must be at least 1\n");
+        exit(-1);
+    }
+
+    graph_t g;
+    double best[N_BENCH];
+    unsigned long count[N_BENCH][2];
+    long rss[N_BENCH];
+    graph_stats_t stats[N_BENCH];
+    bool has_stats[N_BENCH];
+
+    /* Keep the best time of each benchmark. The graph loaded by the
+     * last run of BENCH_LOAD is used by the other benchmarks. */
+    for(int b = 0; b < N_BENCH; b++)
+    {
+        for(int i = 0; i < runs; i++)
+        {
+            if(b == BENCH_LOAD && i > 0)
+                graph_free(&g);
+
+            double t = run_bench(b, &g, graphfile, start, NULL);
+            if(i == 0 || t < best[b])
+                best[b] = t;
+        }
+
+        if(b == BENCH_LOAD && start == GRAPH_NO_VERTEX)
+            start = max_degree_vertex(&g);
+        else if(b == BENCH_LOAD && start >= g.n_vertices)
+        {
+            printf("ERROR: Invalid start vertex %u\n", start);
+            exit(-1);
+        }
+
+        rss[b] = peak_rss();
+
+        /* If libgraph was built with LIBGRAPH_ENABLE_STATS,
+         * keep the statistics of the last timed run */
+        has_stats[b] = graph_stats_last(&stats[b]) == SUCCESS;
+
+        /* Count what the benchmark visited in a separate, untimed run */
+        count[b][0] = count[b][1] = 0;
+        if(b == BENCH_LOAD)
+        {
+            count[b][0] = g.n_vertices;
+            count[b][1] = g.n_edges;
+        }
+        else
+            run_bench(b, &g, graphfile, start, count[b]);
+    }
+
+    printf("{\n  \"graph\": ");
+    print_json_string(graphfile);
+    printf(",\n  \"vertices\": %u,\n  \"edges\": %lu,\n  \"start\": %u,\n  \"runs\": %d,\n",
+           g.n_vertices, g.n_edges, start, runs);
+    printf("  \"benchmarks\": [\n");
+
+    for(int b = 0; b < N_BENCH; b++)
+    {
+        printf("    {\"name\": \"%s\", \"seconds\": %.6f, \"vertices\": %lu, \"edges\": %lu, "
+               "\"edges_per_sec\": %.0f, \"peak_rss_kb\": %ld",
+               bench_names[b], best[b], count[b][0], count[b][1],
+               best[b] > 0 ? count[b][1] / best[b] : 0.0, rss[b]);
+
+        if(has_stats[b])
+            printf(", \"allocations\": %lu, \"queue_max\": %lu",
+                   stats[b].allocations, stats[b].queue_max);
+
+        printf("}%s\n", b + 1 < N_BENCH ? "," : "");
+    }
+
+    printf("  ],\n  \"peak_rss_kb\": %ld\n}\n", peak_rss());
+
+    graph_free(&g);
+
+    return SUCCESS;
+}
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include "graph.h"
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    char *graphfile = NULL, *outfile = NULL;
+
+    /* Parse command-line options */
+    while ((opt = getopt(argc, argv, "g:o:h")) != -1)
+        switch (opt)
+        {
+            case 'g':
+                graphfile = strdup(optarg);
+                break;
+            case 'o':
+                outfile = strdup(optarg);
+                break;
+            case 'h':
+                printf("Usage: graph-convert -g GRAPH_FILE -o BINARY_FILE\n");
+                exit(0);
+                break;
+            default:
+                printf("ERROR: Unknown option -%c\n", opt);
+                exit(-1);
+        }
+
+    /* Validate parameters */
+    if(graphfile == NULL || outfile == NULL)
+    {
+        printf("You must specify files with the -g and -o options\n");
+        exit(-1);
+    }
+
+    int rc;
+    graph_t g;
+
+    rc = graph_load(&g, graphfile);
+    CHECK_STATUS(rc);
+
+    rc = graph_to_bin(&g, outfile);
+    CHECK_STATUS(rc);
+
+    graph_free(&g);
+
+    return SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <time.h>
+#include "generators.h"
+
+
+/* Returns the current time, in seconds */
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    char *type = NULL, *outfile = NULL;
+    unsigned int scale = 16, edge_factor = 16;
+    unsigned int n = 1000, rows = 100, cols = 100;
+    unsigned long m = 0, seed = 1;
+    bool binary = false;
+
+    /* Parse command-line options */
+    while ((opt = getopt(argc, argv, "t:s:e:n:m:r:c:S:o:bh")) != -1)
+        switch (opt)
+        {
+            case 't':
+                type = strdup(optarg);
+                break;
+            case 's':
+                scale = strtoul(optarg, NULL, 10);
+                break;
+            case 'e':
+                edge_factor = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                n = strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                m = strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                rows = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                cols = strtoul(optarg, NULL, 10);
+                break;
+            case 'S':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+            case 'o':
+                outfile = strdup(optarg);
+                break;
+            case 'b':
+                binary = true;
+                break;
+            case 'h':
+                printf("Usage: graph-gen -t rmat|er|grid|dag -o OUTPUT_FILE [-b] [-S SEED]\n"
+                       "         rmat: [-s SCALE] [-e EDGE_FACTOR]\n"
+                       "         er:   [-n VERTICES] [-m EDGES]\n"
+                       "         grid: [-r ROWS] [-c COLS]\n"
+                       "         dag:  [-n VERTICES] [-m EXTRA_EDGES]\n"
+                       "  -b writes a binary file (see graph-convert) instead of a text one\n");
+                exit(0);
+                break;
+            default:
+                printf("ERROR: Unknown option -%c\n", opt);
+                exit(-1);
+        }
+
+    /* Validate parameters */
+    if(type == NULL || outfile == NULL)
+    {
+        printf("You must specify a graph type with -t and an output file with -o\n");
+        exit(-1);
+    }
+
+    int rc;
+    graph_t g;
+    double t = now();
+
+    if(strcmp(type, "rmat") == 0)
+        rc = graph_gen_rmat(&g, scale, edge_factor, GRAPH_RMAT_A, GRAPH_RMAT_B, GRAPH_RMAT_C, seed);
+    else if(strcmp(type, "er") == 0)
+        rc = graph_gen_erdos_renyi(&g, n, m, seed);
+    else if(strcmp(type, "grid") == 0)
+        rc = graph_gen_grid(&g, rows, cols, seed);
+    else if(strcmp(type, "dag") == 0)
+        rc = graph_gen_chain_dag(&g, n, m, seed);
+    else
+    {
+        printf("ERROR: Unknown graph type %s\n", type);
+        exit(-1);
+    }
+    CHECK_STATUS(rc);
+
+    printf("Generated %u vertices, %lu edges in %.3f s\n", g.n_vertices, g.n_edges, now() - t);
+
+    t = now();
+    if(binary)
+        rc = graph_to_bin(&g, outfile);
+    else
+        rc = graph_to_file(&g, outfile);
+    CHECK_STATUS(rc);
+
+    printf("Wrote %s in %.3f s\n", outfile, now() - t);
+
+    graph_free(&g);
+
+    return SUCCESS;
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <time.h>
+#include "graph.h"
+
+
+/* Returns the current time, in seconds */
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* Checks whether two graphs have the same labels and edges */
+static bool graph_equal(graph_t *g1, graph_t *g2)
+{
+    if(g1->n_vertices != g2->n_vertices)
+        return false;
+
+    for(unsigned int i = 0; i < g1->n_vertices; i++)
+    {
+        char *l1 = g1->vertices[i].label, *l2 = g2->vertices[i].label;
+        if((l1 == NULL) != (l2 == NULL) || (l1 != NULL && strcmp(l1, l2) != 0))
+            return false;
+
+        edge_t *e1 = g1->vertices[i].edges, *e2 = g2->vertices[i].edges;
+        while(e1 != NULL && e2 != NULL)
+        {
+            if(graph_vertex_index(g1, e1->to) != graph_vertex_index(g2, e2->to) ||
+               e1->weight != e2->weight)
+                return false;
+
+            e1 = e1->next;
+            e2 = e2->next;
+        }
+
+        if(e1 != NULL || e2 != NULL)
+            return false;
+    }
+
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    char *graphfile = NULL;
+    int runs = 3;
+
+    /* Parse command-line options */
+    while ((opt = getopt(argc, argv, "g:n:h")) != -1)
+        switch (opt)
+        {
+            case 'g':
+                graphfile = strdup(optarg);
+                break;
+            case 'n':
+                runs = strtol(optarg, NULL, 10);
+                break;
+            case 'h':
+                printf("Usage: load-bench -g GRAPH_FILE [-n RUNS]\n");
+                exit(0);
+                break;
+            default:
+                printf("ERROR: Unknown option -%c\n", opt);
+                exit(-1);
+        }
+
+    /* Validate parameters */
+    if(graphfile == NULL)
+    {
+        printf("You must specify a graph file with the -g option\n");
+        exit(-1);
+    }
+
+    if(runs < 1)
+    {
+        printf("The number of runs must be at least 1\n");
+        exit(-1);
+    }
+
+    int rc;
+    graph_t g1, g2;
+    double best_file = 0.0, best_mmap = 0.0;
+
+    /* Keep the best time of each loader */
+    for(int i = 0; i < runs; i++)
+    {
+        double t;
+
+        t = now();
+        rc = graph_from_file(&g1, graphfile);
+        CHECK_STATUS(rc);
+        t = now() - t;
+        if(i == 0 || t < best_file)
+            best_file = t;
+
+        t = now();
+        rc = graph_from_file_mmap(&g2, graphfile);
+        CHECK_STATUS(rc);
+        t = now() - t;
+        if(i == 0 || t < best_mmap)
+            best_mmap = t;
+
+        if(!graph_equal(&g1, &g2))
+        {
+            printf("ERROR: The loaders produced different graphs\n");
+            exit(-1);
+        }
+
+        graph_free(&g1);
+        graph_free(&g2);
+    }
+
+    printf("graph_from_file:      %.3f s\n", best_file);
+    printf("graph_from_file_mmap: %.3f s\n", best_mmap);
+    printf("Speedup:              %.2fx\n", best_file / best_mmap);
+
+    return SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <time.h>
+#include "flow.h"
+
+
+/* Returns the current time, in seconds */
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* Returns the label of a vertex */
+static const char *label(graph_t *g, unsigned int i)
+{
+    return g->vertices[i].label ? g->vertices[i].label : "NO LABEL";
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    char *graphfile = NULL;
+    char *source_label = NULL, *sink_label = NULL;
+    int algorithm = GRAPH_FLOW_DINIC;
+    bool print = false;
+
+    /* Parse command-line options */
+    while ((opt = getopt(argc, argv, "g:s:f:a:ph")) != -1)
+        switch (opt)
+        {
+            case 'g':
+                graphfile = strdup(optarg);
+                break;
+            case 's':
+                source_label = strdup(optarg);
+                break;
+            case 'f':
+                sink_label = strdup(optarg);
+                break;
+            case 'a':
+                if(strcmp(optarg, "dinic") == 0)
+                    algorithm = GRAPH_FLOW_DINIC;
+                else if(strcmp(optarg, "push-relabel") == 0)
+                    algorithm = GRAPH_FLOW_PUSH_RELABEL;
+                else
+                {
+                    printf("ERROR: Unknown algorithm %s\n", optarg);
+                    exit(-1);
+                }
+                break;
+            case 'p':
+                print = true;
+                break;
+            case 'h':
+                printf("Usage: maxflow -g GRAPH_FILE -s SOURCE_VERTEX -f SINK_VERTEX "
+                       "[-a dinic|push-relabel] [-p]\n");
+                exit(0);
+                break;
+            default:
+                printf("ERROR: Unknown option -%c\n", opt);
+                exit(-1);
+        }
+
+    /* Validate parameters */
+    if(graphfile == NULL)
+    {
+        printf("You must specify a graph file with the -g option\n");
+        exit(-1);
+    }
+
+    if(source_label == NULL || sink_label == NULL)
+    {
+        printf("You must specify a source and a sink vertex with -s and -f\n");
+        exit(-1);
+    }
+
+    int rc;
+    vertex_t *source_vertex, *sink_vertex;
+    graph_t g;
+    graph_flow_t flow;
+
+    rc = graph_load(&g, graphfile);
+    CHECK_STATUS(rc);
+
+    rc = graph_get_vertex_lbl(&g, source_label, &source_vertex);
+    if(rc == ENOTFOUND)
+    {
+        printf("No such vertex in graph: %s\n", source_label);
+        return ENOTFOUND;
+    }
+
+    rc = graph_get_vertex_lbl(&g, sink_label, &sink_vertex);
+    if(rc == ENOTFOUND)
+    {
+        printf("No such vertex in graph: %s\n", sink_label);
+        return ENOTFOUND;
+    }
+
+    unsigned int source = graph_vertex_index(&g, source_vertex);
+    unsigned int sink = graph_vertex_index(&g, sink_vertex);
+
+    double t = now();
+    rc = graph_max_flow(&g, source, sink, algorithm, &flow);
+    CHECK_STATUS(rc);
+    t = now() - t;
+
+    printf("Maximum flow: %.2f (%.3f s)\n", flow.value, t);
+
+    /* The edges of the cut are the ones that cross it from the source side */
+    printf("Minimum cut:\n");
+
+    for(unsigned int i = 0; i < g.n_vertices; i++)
+        for(edge_t *e = g.vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned int j = graph_vertex_index(&g, e->to);
+
+            if(flow.source_side[i] && !flow.source_side[j])
+                printf("  %s -> %s (%.2f)\n", label(&g, i), label(&g, j), e->weight);
+        }
+
+    if(print)
+    {
+        printf("Flows:\n");
+
+        /* The flows are in the same order as the edges of a CSR snapshot */
+        unsigned long k = 0;
+        for(unsigned int i = 0; i < g.n_vertices; i++)
+            for(edge_t *e = g.vertices[i].edges; e != NULL; e = e->next, k++)
+                if(flow.flow[k] > 0)
+                    printf("  %s -> %s: %.2f / %.2f\n", label(&g, i),
+                           label(&g, graph_vertex_index(&g, e->to)), flow.flow[k], e->weight);
+    }
+
+    graph_flow_free(&flow);
+    graph_free(&g);
+
+    return SUCCESS;
+}
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <time.h>
+#include "algorithms.h"
+
+
+/* Returns the current time, in seconds */
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* Prints the edges of a spanning forest (each of them once) */
+static void print_tree(graph_t *tree)
+{
+    for(unsigned int i = 0; i < tree->n_vertices; i++)
+        for(edge_t *e = tree->vertices[i].edges; e != NULL; e = e->next)
+        {
+            unsigned int j = graph_vertex_index(tree, e->to);
+            char *from = tree->vertices[i].label, *to = tree->vertices[j].label;
+
+            if(i < j)
+                printf("%s -- %s (%.2f)\n", from ? from : "NO LABEL",
+                       to ? to : "NO LABEL", e->weight);
+        }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    char *graphfile = NULL;
+    bool kruskal = true, prim = true;
+    bool print = false;
+    unsigned int n_threads = 0;
+    int runs = 1;
+
+    /* Parse command-line options */
+    while ((opt = getopt(argc, argv, "g:a:t:n:ph")) != -1)
+        switch (opt)
+        {
+            case 'g':
+                graphfile = strdup(optarg);
+                break;
+            case 'a':
+                kruskal = strcmp(optarg, "kruskal") == 0;
+                prim = strcmp(optarg, "prim") == 0;
+                if(!kruskal && !prim)
+                {
+                    printf("ERROR: Unknown algorithm %s\n", optarg);
+                    exit(-1);
+                }
+                break;
+            case 't':
+                n_threads = strtol(optarg, NULL, 10);
+                break;
+            case 'n':
+                runs = strtol(optarg, NULL, 10);
+                break;
+            case 'p':
+                print = true;
+                break;
+            case 'h':
+                printf("Usage: mst -g GRAPH_FILE [-a kruskal|prim] [-t THREADS] [-n RUNS] [-p]\n");
+                exit(0);
+                break;
+            default:
+                printf("ERROR: Unknown option -%c\n", opt);
+                exit(-1);
+        }
+
+    /* Validate parameters */
+    if(graphfile == NULL)
+    {
+        printf("You must specify a graph file with the -g option\n");
+        exit(-1);
+    }
+
+    if(runs < 1)
+    {
+        printf("The number of runs must be at least 1\n");
+        exit(-1);
+    }
+
+    int rc;
+    graph_t g;
+    graph_t *tree = NULL;
+
+    rc = graph_load(&g, graphfile);
+    CHECK_STATUS(rc);
+
+    printf("%u vertices, %lu edges\n", g.n_vertices, g.n_edges);
+
+    /* Run each algorithm (keeping the best time and the last tree) */
+    for(int a = 0; a < 2; a++)
+    {
+        if((a == 0 && !kruskal) || (a == 1 && !prim))
+            continue;
+
+        double best = 0.0, weight = 0.0;
+
+        for(int i = 0; i < runs; i++)
+        {
+            if(tree != NULL)
+            {
+                graph_free(tree);
+                free(tree);
+            }
+
+            double t = now();
+            if(a == 0)
+                rc = graph_mst_kruskal(&g, n_threads, &tree, &weight);
+            else
+                rc = graph_mst_prim(&g, &tree, &weight);
+            CHECK_STATUS(rc);
+            t = now() - t;
+
+            if(i == 0 || t < best)
+                best = t;
+        }
+
+        printf("%-8s weight %.2f, %lu edges, %.3f s\n", a == 0 ? "Kruskal:" : "Prim:",
+               weight, tree->n_edges / 2, best);
+    }
+
+    if(print)
+        print_tree(tree);
+
+    graph_free(tree);
+    free(tree);
+    graph_free(&g);
+
+    return SUCCESS;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <math.h>
+#include "algorithms.h"
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    char *graphfile = NULL;
+    char *start_label = NULL, *final_label = NULL;
+
+    /* Parse command-line options */
+    while ((opt = getopt(argc, argv, "g:s:f:h")) != -1)
+        switch (opt)
+        {
+            case 'g':
+                graphfile = strdup(optarg);
+                break;
+            case 's':
+                start_label = strdup(optarg);
+                break;
+            case 'f':
+                final_label = strdup(optarg);
+                break;
+            case 'h':
+                printf("Usage: shortest-path -g GRAPH_FILE -s START_VERTEX -f FINAL_VERTEX\n");
+                exit(0);
+                break;
+            default:
+                printf("ERROR: Unknown option -%c\n", opt);
+                exit(-1);
+        }
+
+    /* Validate parameters */
+    if(graphfile == NULL)
+    {
+        printf("You must specify files a graph file with the -g option\n");
+        exit(-1);
+    }
+
+    if(start_label == NULL || final_label == NULL)
+    {
+        printf("You must specify files a start and final vertex with -s and -f\n");
+        exit(-1);
+    }
+
+    int rc;
+    vertex_t *start_vertex, *final_vertex;
+    graph_t g;
+
+    rc = graph_load(&g, graphfile);
+    CHECK_STATUS(rc);
+
+    rc = graph_get_vertex_lbl(&g, start_label, &start_vertex);
+    if(rc == ENOTFOUND)
+    {
+        printf("No such vertex in graph: %s\n", start_label);
+        return ENOTFOUND;
+    }
+
+    rc = graph_get_vertex_lbl(&g, final_label, &final_vertex);
+    if(rc == ENOTFOUND)
+    {
+        printf("No such vertex in graph: %s\n", final_label);
+        return ENOTFOUND;
+    }
+
+    unsigned int start = graph_vertex_index(&g, start_vertex);
+    unsigned int final = graph_vertex_index(&g, final_vertex);
+    double *dist = malloc(g.n_vertices * sizeof(double));
+    unsigned int *pred = malloc(g.n_vertices * sizeof(unsigned int));
+    unsigned int *path = malloc(g.n_vertices * sizeof(unsigned int));
+
+    if(dist == NULL || pred == NULL || path == NULL)
+        CHECK_STATUS(ENOMEM);
+
+    rc = graph_shortest_path(&g, start, final, dist, pred);
+    CHECK_STATUS(rc);
+
+    if(isinf(dist[final]))
+    {
+        printf("No path from %s to %s\n", start_label, final_label);
+        return SUCCESS;
+    }
+
+    /* Follow the predecessors back from the final vertex */
+    unsigned int n_path = 0;
+    unsigned int v = final;
+    do
+    {
+        path[n_path++] = v;
+        v = pred[v];
+    } while(v != GRAPH_NO_VERTEX);
+
+    printf("%s", g.vertices[path[n_path - 1]].label);
+    for(unsigned int i = n_path - 1; i > 0; i--)
+        printf(" -> %s", g.vertices[path[i - 1]].label);
+
+    printf("\nTotal weight: %.2f\n", dist[final]);
+
+    free(dist);
+    free(pred);
+    free(path);
+    graph_free(&g);
+
+    return SUCCESS;
+}
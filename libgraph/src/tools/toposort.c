@@ -5,14 +5,34 @@
 #include <getopt.h>
 #include "algorithms.h"
 
+
+/* Compares two vertex indices, for qsort */
+static int cmp_index(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *) a, y = *(const unsigned int *) b;
+    return (x > y) - (x < y);
+}
+
+
+/* Prints the label of a vertex */
+static void print_label(graph_t *g, unsigned int i)
+{
+    char *label = g->vertices[i].label;
+    printf("%s ", label ? label : "NO LABEL");
+}
+
+
 int main(int argc, char *argv[])
 {
     int opt;
     char *graphfile = NULL;
     int start_vertex = 0;
+    bool all = false;
+    bool levels = false;
+    unsigned int n_threads = 0;
 
     /* Parse command-line options */
-    while ((opt = getopt(argc, argv, "g:s:h")) != -1)
+    while ((opt = getopt(argc, argv, "g:s:alt:h")) != -1)
         switch (opt)
         {
             case 'g':
@@ -21,8 +41,17 @@ int main(int argc, char *argv[])
             case 's':
                 start_vertex = strtol(optarg, NULL, 10);
                 break;
+            case 'a':
+                all = true;
+                break;
+            case 'l':
+                levels = true;
+                break;
+            case 't':
+                n_threads = strtol(optarg, NULL, 10);
+                break;
             case 'h':
-                printf("Usage: toposort -g GRAPH_FILE -s START_VERTEX \n");
+                printf("Usage: toposort -g GRAPH_FILE [-s START_VERTEX | -a | -l [-t THREADS]]\n");
                 exit(0);
                 break;
             default:
@@ -41,9 +70,82 @@ int main(int argc, char *argv[])
     graph_t g;
     vlist_t *l;
 
-    rc = graph_from_file(&g, graphfile);
+    rc = graph_load(&g, graphfile);
     CHECK_STATUS(rc);
 
+    if(all)
+    {
+        /* Sort the whole graph, and report a cycle if there is one */
+        unsigned int *order = malloc(g.n_vertices * sizeof(unsigned int));
+        unsigned int *cycle = malloc(g.n_vertices * sizeof(unsigned int));
+        unsigned int n_cycle;
+
+        if(order == NULL || cycle == NULL)
+            CHECK_STATUS(ENOMEM);
+
+        rc = graph_toposort_kahn(&g, order, cycle, &n_cycle);
+        if(rc == ECYCLE)
+        {
+            printf("ERROR: The graph has a cycle: ");
+            for(unsigned int i = 0; i <= n_cycle; i++)
+                print_label(&g, cycle[i % n_cycle]);
+            printf("\n");
+            exit(rc);
+        }
+        CHECK_STATUS(rc);
+
+        for(unsigned int i = 0; i < g.n_vertices; i++)
+            print_label(&g, order[i]);
+        printf("\n\n");
+
+        return SUCCESS;
+    }
+
+    if(levels)
+    {
+        /* Print the vertices that can run concurrently, level by level,
+         * and the critical path (using edge weights as durations) */
+        unsigned int *order = malloc(g.n_vertices * sizeof(unsigned int));
+        unsigned int *level_start = malloc((g.n_vertices + 1) * sizeof(unsigned int));
+        unsigned int *path = malloc(g.n_vertices * sizeof(unsigned int));
+        unsigned int n_levels, n_path;
+        double length;
+
+        if(order == NULL || level_start == NULL || path == NULL)
+            CHECK_STATUS(ENOMEM);
+
+        rc = graph_toposort_levels(&g, n_threads, order, level_start, &n_levels);
+        if(rc == ECYCLE)
+        {
+            printf("ERROR: The graph has a cycle\n");
+            exit(rc);
+        }
+        CHECK_STATUS(rc);
+
+        for(unsigned int l = 0; l < n_levels; l++)
+        {
+            unsigned int *level = order + level_start[l];
+            unsigned int size = level_start[l + 1] - level_start[l];
+
+            qsort(level, size, sizeof(unsigned int), cmp_index);
+
+            printf("Level %u: ", l);
+            for(unsigned int i = 0; i < size; i++)
+                print_label(&g, level[i]);
+            printf("\n");
+        }
+
+        rc = graph_critical_path(&g, order, &length, path, &n_path);
+        CHECK_STATUS(rc);
+
+        printf("Critical path (length %g): ", length);
+        for(unsigned int i = 0; i < n_path; i++)
+            print_label(&g, path[i]);
+        printf("\n");
+
+        return SUCCESS;
+    }
+
     rc = graph_toposort(&g, start_vertex, &l);
     CHECK_STATUS(rc);
     vlist_print(l);